@@ -29,6 +29,7 @@
 #include <QDebug>
 #include <QFile>
 #include <QDir>
+#include <QElapsedTimer>
 #include <QFileInfo>
 #include <QRegularExpression>
 #include <QDataStream>
@@ -39,6 +40,9 @@
 
 #include "jsonutils.h"
 #include "canvasconnection.h"
+#include "snapshotfile.h"
+#include "snapshotcompression.h"
+#include "snapshotjournal.h"
 
 ApplicationController::ApplicationController(QObject *parent)
     : QObject(parent)
@@ -102,6 +106,32 @@ void ApplicationController::loadFromFile(QString path)
 void ApplicationController::setDaemonMode()
 {
     m_daemonMode = true;
+
+    // a daemon always journals, so it can start from the last known state
+    if (m_journalDirectory.isEmpty()) {
+        setJournalDirectory(QDir(QStandardPaths::writableLocation(QStandardPaths::AppDataLocation)).filePath("Journal"));
+    }
+}
+
+void ApplicationController::setPreferBinaryFrames(bool binary)
+{
+    m_preferBinaryFrames = binary;
+}
+
+void ApplicationController::setRecordingDirectory(QString dir)
+{
+    m_recordingDirectory = dir;
+    for (auto cc : m_activeCanvases) {
+        cc->setRecordingDirectory(dir);
+    }
+}
+
+void ApplicationController::setJournalDirectory(QString dir)
+{
+    m_journalDirectory = dir;
+    for (auto cc : m_activeCanvases) {
+        cc->setJournalDirectory(dir);
+    }
 }
 
 void ApplicationController::save(QString configName)
@@ -156,7 +186,7 @@ void ApplicationController::rebuildConfigData()
     emit configListChanged(m_configs);
 }
 
-void ApplicationController::saveSnapshot(QString snapshotName)
+void ApplicationController::saveSnapshot(QString snapshotName, bool bundleAssets)
 {
     QDir d(QStandardPaths::writableLocation(QStandardPaths::AppDataLocation));
     d.cd("Snapshots");
@@ -172,14 +202,21 @@ void ApplicationController::saveSnapshot(QString snapshotName)
         return;
     }
 
-    f.open(QIODevice::WriteOnly | QIODevice::Truncate);
-    f.write(createSnapshot(snapshotName));
-
-    QVariantMap m;
-    m["path"] = f.fileName();
-    m["name"] = snapshotName;
-    m_snapshots.append(m);
-    emit snapshotListChanged();
+    // the trees are copied here, on the GUI thread which owns them;
+    // compressing and writing them out happens in the background
+    const QString path = f.fileName();
+    SnapshotSaver* saver = new SnapshotSaver(createSnapshot(snapshotName, bundleAssets), path, this);
+    connect(saver, &SnapshotSaver::saved, this, [this, path, snapshotName](bool ok) {
+        if (ok) {
+            QVariantMap m;
+            m["path"] = path;
+            m["name"] = snapshotName;
+            m_snapshots.append(m);
+            emit snapshotListChanged();
+        }
+    }, Qt::QueuedConnection);
+    connect(saver, &QThread::finished, saver, &QObject::deleteLater);
+    saver->start(QThread::LowPriority);
 }
 
 void ApplicationController::restoreSnapshot(int index)
@@ -191,8 +228,26 @@ void ApplicationController::restoreSnapshot(int index)
         return;
     }
 
+    if (SnapshotFile::hasSignature(&f)) {
+        SnapshotFile::Ptr snapshot = SnapshotFile::open(path);
+        if (!snapshot) {
+            return;
+        }
+
+        clearConnections();
+        for (int i=0; i < snapshot->canvasCount(); ++i) {
+            CanvasConnection* cc = new CanvasConnection(this);
+            cc->restoreSnapshot(snapshot, i);
+            m_activeCanvases.append(cc);
+        }
+
+        emit activeCanvasesChanged();
+        return;
+    }
+
     clearConnections();
 
+    // version 1: a QDataStream of the whole tree
     {
         QDataStream ds(&f);
         int version, canvasCount;
@@ -209,6 +264,37 @@ void ApplicationController::restoreSnapshot(int index)
     emit activeCanvasesChanged();
 }
 
+bool ApplicationController::restoreJournal()
+{
+    if (m_journalDirectory.isEmpty()) {
+        return false;
+    }
+
+    QList<CanvasConnection*> restored;
+    QDir d(m_journalDirectory);
+    for (const QString& canvasDir : d.entryList(QDir::Dirs | QDir::NoDotAndDotDot)) {
+        CanvasConnection* cc = new CanvasConnection(this);
+        cc->setNetworkAccess(m_netAccess);
+        if (!cc->restoreJournal(d.filePath(canvasDir))) {
+            delete cc;
+            continue;
+        }
+
+        cc->setJournalDirectory(m_journalDirectory);
+        restored.append(cc);
+    }
+
+    if (restored.isEmpty()) {
+        qWarning() << "no journaled canvases found in" << m_journalDirectory;
+        return false;
+    }
+
+    clearConnections();
+    m_activeCanvases = restored;
+    emit activeCanvasesChanged();
+    return true;
+}
+
 void ApplicationController::rebuildSnapshotData()
 {
     m_snapshots.clear();
@@ -222,7 +308,12 @@ void ApplicationController::rebuildSnapshotData()
     Q_FOREACH (auto entry, d.entryList(QStringList() << "*.fgcanvassnapshot")) {
         QFile f(d.filePath(entry));
         f.open(QIODevice::ReadOnly);
-        {
+        if (SnapshotFile::hasSignature(&f)) {
+            QVariantMap m;
+            m["path"] = f.fileName();
+            m["name"] = SnapshotFile::readName(f.fileName());
+            m_snapshots.append(m);
+        } else {
             QDataStream ds(&f);
             int version;
             QString name;
@@ -328,6 +419,9 @@ void ApplicationController::openCanvas(QString path)
     CanvasConnection* cc = new CanvasConnection(this);
 
     cc->setNetworkAccess(m_netAccess);
+    cc->setPreferBinaryFrames(m_preferBinaryFrames);
+    cc->setRecordingDirectory(m_recordingDirectory);
+    cc->setJournalDirectory(m_journalDirectory);
     m_activeCanvases.append(cc);
 
     cc->setRootPropertyPath(path.toUtf8());
@@ -530,12 +624,42 @@ void ApplicationController::restoreState(QByteArray bytes)
         cc->setNetworkAccess(m_netAccess);
         m_activeCanvases.append(cc);
         cc->restoreState(c.toObject());
+        if (m_preferBinaryFrames)
+            cc->setPreferBinaryFrames(true);
+        cc->setRecordingDirectory(m_recordingDirectory);
+        cc->setJournalDirectory(m_journalDirectory);
+        if (m_daemonMode) {
+            warmStart(cc);
+        }
         cc->reconnect();
     }
 
     emit activeCanvasesChanged();
 }
 
+void ApplicationController::warmStart(CanvasConnection* cc)
+{
+    if (m_journalDirectory.isEmpty()) {
+        return;
+    }
+
+    // show the last known state until the connection is up: it then takes
+    // over by resyncing against this tree, rather than building a new one
+    QElapsedTimer t;
+    t.start();
+    const QRectF configured(cc->origin(), cc->size());
+    const QString dir = SnapshotJournal::canvasDirectory(m_journalDirectory, cc->webSocketUrl(),
+                                                         cc->rootPath().toUtf8());
+    if (!cc->restoreJournal(dir)) {
+        return;
+    }
+
+    // the configuration, not the checkpoint, decides where the canvas goes
+    cc->setOrigin(configured.topLeft());
+    cc->setSize(configured.size());
+    qDebug() << "warm start of" << cc->webSocketUrl() << cc->rootPath() << "took" << t.elapsed() << "msec";
+}
+
 void ApplicationController::clearConnections()
 {
     Q_FOREACH(auto c, m_activeCanvases) {
@@ -545,21 +669,14 @@ void ApplicationController::clearConnections()
     emit activeCanvasesChanged();
 }
 
-QByteArray ApplicationController::createSnapshot(QString name) const
+std::unique_ptr<SnapshotWriter> ApplicationController::createSnapshot(QString name, bool bundleAssets) const
 {
-    QByteArray bytes;
-    const int version = 1;
-    {
-         QDataStream ds(&bytes, QIODevice::WriteOnly);
-         ds << version << name;
-
-         ds << m_activeCanvases.size();
-         Q_FOREACH(auto c, m_activeCanvases) {
-             c->saveSnapshot(ds);
-         }
+    std::unique_ptr<SnapshotWriter> writer(new SnapshotWriter(name));
+    Q_FOREACH(auto c, m_activeCanvases) {
+        c->saveSnapshot(*writer, bundleAssets);
     }
 
-    return bytes;
+    return writer;
 }
 
 bool ApplicationController::eventFilter(QObject* obj, QEvent* event)
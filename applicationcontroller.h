@@ -18,6 +18,8 @@
 #ifndef APPLICATIONCONTROLLER_H
 #define APPLICATIONCONTROLLER_H
 
+#include <memory>
+
 #include <QObject>
 #include <QAbstractListModel>
 #include <QNetworkAccessManager>
@@ -25,6 +27,7 @@
 #include <QVariantList>
 
 class CanvasConnection;
+class SnapshotWriter;
 class QWindow;
 class QTimer;
 
@@ -62,8 +65,17 @@ public:
 
     void loadFromFile(QString path);
 
+    /// reconnect automatically, and journal (by default, into the application
+    /// data directory) so canvases restored later start from their last state
     void setDaemonMode();
 
+    void setPreferBinaryFrames(bool binary);
+
+    void setRecordingDirectory(QString dir);
+
+    /// journal the state of each canvas into dir, see CanvasConnection::setJournalDirectory
+    void setJournalDirectory(QString dir);
+
     Q_INVOKABLE void query();
     Q_INVOKABLE void cancelQuery();
     Q_INVOKABLE void clearQuery();
@@ -76,9 +88,19 @@ public:
     Q_INVOKABLE void openCanvas(QString path);
     Q_INVOKABLE void closeCanvas(CanvasConnection* canvas);
 
-    Q_INVOKABLE void saveSnapshot(QString snapshotName);
+    /**
+     * @brief save the active canvases. A bundle also holds the images and
+     * fonts they use, so it can be restored on a display with no network.
+     */
+    Q_INVOKABLE void saveSnapshot(QString snapshotName, bool bundleAssets = false);
     Q_INVOKABLE void restoreSnapshot(int index);
 
+    /**
+     * @brief replace the active canvases with the last known state of each
+     * canvas in the journal directory. Returns false if none was found.
+     */
+    Q_INVOKABLE bool restoreJournal();
+
     QString host() const;
 
     unsigned int port() const;
@@ -177,7 +199,10 @@ private:
     QByteArray saveState(QString name) const;
     void restoreState(QByteArray bytes);
 
-    QByteArray createSnapshot(QString name) const;
+    /// show a restored canvas's journaled state while it connects
+    void warmStart(CanvasConnection* cc);
+
+    std::unique_ptr<SnapshotWriter> createSnapshot(QString name, bool bundleAssets) const;
 
     QString m_host;
     unsigned int m_port;
@@ -193,6 +218,9 @@ private:
     Qt::WindowState m_windowState = Qt::WindowNoState;
 
     bool m_daemonMode = false;
+    bool m_preferBinaryFrames = false;
+    QString m_recordingDirectory;
+    QString m_journalDirectory;
     bool m_showUI = true;
     bool m_blockUIIdle = false;
     QTimer* m_uiIdleTimer;
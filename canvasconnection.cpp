@@ -19,26 +19,42 @@
 
 #include <QUrl>
 #include <QDebug>
-#include <QJsonDocument>
 #include <QJsonArray>
 #include <QJsonObject>
-#include <QJsonValue>
 #include <QNetworkRequest>
 #include <QNetworkAccessManager>
 #include <QNetworkReply>
 #include <QDataStream>
+#include <QUrlQuery>
+#include <QGuiApplication>
+#include <QScreen>
+#include <QPixmap>
+#include <QImage>
 
 #include "localprop.h"
 #include "fgqcanvasfontcache.h"
 #include "fgqcanvasimageloader.h"
 #include "jsonutils.h"
+#include "canvasconnectionworker.h"
+#include "snapshotjournal.h"
+
+// the initial sync ends when updates follow it; if nothing does (a static
+// canvas), once no more nodes have arrived for this long
+static const int InitialSyncQuietMsec = 250;
 
 CanvasConnection::CanvasConnection(QObject *parent) : QObject(parent)
 {
-    connect(&m_webSocket, &QWebSocket::connected, this, &CanvasConnection::onWebSocketConnected);
-    connect(&m_webSocket, &QWebSocket::disconnected, this, &CanvasConnection::onWebSocketClosed);
-    connect(&m_webSocket, &QWebSocket::textMessageReceived,
-            this, &CanvasConnection::onTextMessageReceived);
+    // socket reading and frame decoding happen on the worker thread
+    m_worker = new CanvasConnectionWorker;
+    m_worker->moveToThread(&m_workerThread);
+    connect(m_worker, &CanvasConnectionWorker::connected, this, &CanvasConnection::onWebSocketConnected);
+    connect(m_worker, &CanvasConnectionWorker::disconnected, this, &CanvasConnection::onWebSocketClosed);
+    connect(m_worker, &CanvasConnectionWorker::framesAvailable,
+            this, &CanvasConnection::onFramesAvailable);
+    connect(m_worker, &CanvasConnectionWorker::overflowed,
+            this, &CanvasConnection::onWorkerOverflowed);
+    m_workerThread.setObjectName("CanvasConnectionWorker");
+    m_workerThread.start();
 
     m_destRect = QRectF(50, 50, 400, 400);
     m_reconnectTimer = new QTimer(this);
@@ -46,13 +62,32 @@ CanvasConnection::CanvasConnection(QObject *parent) : QObject(parent)
     m_reconnectTimer->setSingleShot(true);
     connect(m_reconnectTimer, &QTimer::timeout,
             this, &CanvasConnection::reconnect);
+
+    if (qGuiApp && qGuiApp->primaryScreen() && (qGuiApp->primaryScreen()->refreshRate() > 1.0)) {
+        m_frameIntervalMsec = qMax(1, qRound(1000.0 / qGuiApp->primaryScreen()->refreshRate()));
+    }
+
+    m_applyTimer = new QTimer(this);
+    m_applyTimer->setSingleShot(true);
+    m_applyTimer->setTimerType(Qt::PreciseTimer);
+    connect(m_applyTimer, &QTimer::timeout,
+            this, &CanvasConnection::applyPendingFrames);
+
+    m_initialSyncQuietTimer = new QTimer(this);
+    m_initialSyncQuietTimer->setSingleShot(true);
+    m_initialSyncQuietTimer->setInterval(InitialSyncQuietMsec);
+    connect(m_initialSyncQuietTimer, &QTimer::timeout,
+            this, &CanvasConnection::onInitialSyncQuiet);
 }
 
 CanvasConnection::~CanvasConnection()
 {
-    disconnect(&m_webSocket, &QWebSocket::disconnected,
-               this, &CanvasConnection::onWebSocketClosed);
-    m_webSocket.close();
+    disconnect(m_worker, nullptr, this, nullptr);
+    QMetaObject::invokeMethod(m_worker, "close", Qt::BlockingQueuedConnection);
+    m_workerThread.quit();
+    m_workerThread.wait();
+    delete m_worker;
+    dropPropertyTree();
 }
 
 void CanvasConnection::setNetworkAccess(QNetworkAccessManager *dl)
@@ -71,12 +106,24 @@ void CanvasConnection::setAutoReconnect()
     m_autoReconnect = true;
 }
 
+void CanvasConnection::setPreferBinaryFrames(bool binary)
+{
+    m_preferBinaryFrames = binary;
+}
+
+void CanvasConnection::setRecordingDirectory(QString dir)
+{
+    QMetaObject::invokeMethod(m_worker, "setRecordingDirectory", Qt::QueuedConnection,
+                              Q_ARG(QString, dir));
+}
+
 QJsonObject CanvasConnection::saveState() const
 {
     QJsonObject json;
     json["url"] = m_webSocketUrl.toString();
     json["path"] = QString::fromUtf8(m_rootPropertyPath);
     json["rect"] = rectToJsonArray(m_destRect.toRect());
+    json["binary-frames"] = m_preferBinaryFrames;
     return json;
 }
 
@@ -85,6 +132,7 @@ bool CanvasConnection::restoreState(QJsonObject state)
     m_webSocketUrl = state.value("url").toString();
     m_rootPropertyPath = state.value("path").toString().toUtf8();
     m_destRect = jsonArrayToRect(state.value("rect").toArray());
+    m_preferBinaryFrames = state.value("binary-frames").toBool();
 
     emit geometryChanged();
     emit rootPathChanged();
@@ -93,16 +141,220 @@ bool CanvasConnection::restoreState(QJsonObject state)
     return true;
 }
 
-void CanvasConnection::saveSnapshot(QDataStream &ds) const
+void CanvasConnection::saveSnapshot(SnapshotWriter& writer, bool bundleAssets) const
+{
+    LocalProp* root = propertyRoot();
+    writer.addCanvas(m_webSocketUrl, m_rootPropertyPath, m_destRect, root);
+    if (bundleAssets && root) {
+        addSnapshotAssets(writer, root);
+    }
+}
+
+void CanvasConnection::addSnapshotAssets(SnapshotWriter& writer, const LocalProp* prop) const
+{
+    for (const LocalProp* child : prop->children()) {
+        // images are the file of an image element; fonts cascade, so can be
+        // set on any element
+        const bool isImage = (child->nameAtom() == PropName::File) && (prop->nameAtom() == PropName::Image);
+        const bool isFont = (child->nameAtom() == PropName::Font);
+        const QByteArray path = (isImage || isFont) ? child->value().toByteArray() : QByteArray();
+        if (!path.isEmpty() && !writer.hasAsset(path)) {
+            if (isImage) {
+                const QPixmap pix = imageLoader()->cachedImage(path);
+                if (pix.isNull()) {
+                    qWarning() << "not bundling image" << path << ": it hasn't been loaded";
+                } else {
+                    writer.addImage(path, pix.toImage());
+                }
+            } else {
+                const QByteArray data = fontCache()->fontData(path);
+                if (data.isEmpty()) {
+                    qWarning() << "not bundling font" << path << ": it hasn't been loaded";
+                } else {
+                    writer.addFont(path, data);
+                }
+            }
+        }
+
+        addSnapshotAssets(writer, child);
+    }
+}
+
+void CanvasConnection::restoreSnapshot(SnapshotFile::Ptr file, int canvas)
+{
+    m_webSocketUrl = file->canvasUrl(canvas);
+    m_rootPropertyPath = file->canvasRootPath(canvas);
+    m_destRect = file->canvasDestRect(canvas);
+    dropPropertyTree();
+    m_snapshot = file;
+    m_snapshotCanvas = canvas;
+    if (file->hasAssets()) {
+        // bundled images and fonts are used instead of the network
+        imageLoader()->setBundle(file);
+        fontCache()->setBundle(file);
+    }
+    setStatus(Snapshot);
+
+    emit geometryChanged();
+    emit rootPathChanged();
+    emit webSocketUrlChanged();
+
+    emit updated();
+}
+
+void CanvasConnection::materializeSnapshot()
+{
+    const quint32 root = m_snapshot->canvasRootNode(m_snapshotCanvas);
+    if (root != SnapshotFormat::NoIndex) {
+        m_localPropertyRoot = LocalProp::restoreFromSnapshot(*m_snapshot, root, nullptr, &m_propertyArena);
+        if (m_publishVersions) {
+            m_publisher.publish(m_localPropertyRoot);
+        }
+    }
+
+    // the mapping is released once every canvas restored from it is built,
+    // unless it bundles assets, which the loaders go on using
+    m_snapshot.reset();
+    m_snapshotCanvas = -1;
+}
+
+// the PropertyTreeMirror ids live in the tree, with their paths below the
+// root, so that journaled frames can be replayed over a checkpoint
+static void collectMirrorIds(const LocalProp* prop, const QByteArray& path,
+                             SnapshotJournal::IdPaths& ids)
+{
+    if (prop->mirrorId() >= 0) {
+        ids.push_back(SnapshotJournal::IdPath{prop->mirrorId(), path});
+    }
+
+    const QByteArray prefix = path.isEmpty() ? path : path + '/';
+    for (const PackedRun* run = prop->packedRuns(); run; run = run->next()) {
+        for (unsigned int i = 0; i < run->size(); ++i) {
+            if (run->mirrorId(i) >= 0) {
+                ids.push_back(SnapshotJournal::IdPath{run->mirrorId(i),
+                              prefix + nameString(run->name()) + '[' + QByteArray::number(i) + ']'});
+            }
+        }
+    }
+
+    for (const LocalProp* child : prop->children()) {
+        QByteArray childPath = prefix + child->name();
+        if (child->index() > 0) {
+            childPath += '[' + QByteArray::number(child->index()) + ']';
+        }
+        collectMirrorIds(child, childPath, ids);
+    }
+}
+
+void CanvasConnection::setJournalDirectory(QString dir)
+{
+    m_journalDirectory = dir;
+    if (dir.isEmpty()) {
+        m_journal.reset();
+    } else if ((m_status == Connected) && !m_initialSync) {
+        takeJournalCheckpoint();
+    }
+}
+
+void CanvasConnection::takeJournalCheckpoint()
+{
+    if (m_journalDirectory.isEmpty() || !m_localPropertyRoot) {
+        return;
+    }
+
+    const QString dir = SnapshotJournal::canvasDirectory(m_journalDirectory, m_webSocketUrl, m_rootPropertyPath);
+    if (!m_journal || (m_journal->directory() != dir)) {
+        SnapshotJournal::Settings settings;
+        settings.directory = m_journalDirectory;
+        m_journal.reset(new SnapshotJournal(m_webSocketUrl, m_rootPropertyPath, settings));
+    }
+
+    // copied here, on the thread owning the tree; written in the background
+    std::unique_ptr<SnapshotWriter> writer(new SnapshotWriter(rootPath()));
+    saveSnapshot(*writer);
+    SnapshotJournal::IdPaths ids;
+    collectMirrorIds(m_localPropertyRoot, QByteArray(), ids);
+    m_journal->checkpoint(std::move(writer), std::move(ids));
+}
+
+bool CanvasConnection::restoreJournal(const QString& directory)
 {
-    ds << m_webSocketUrl << m_rootPropertyPath << m_destRect;
-    m_localPropertyRoot->saveToStream(ds);
+    SnapshotJournalReader reader;
+    if (!reader.open(directory)) {
+        return false;
+    }
+
+    restoreSnapshot(reader.checkpoint(), 0);
+    if (!propertyRoot()) {
+        return true; // the canvas had no tree, nothing to replay over
+    }
+
+    int frameCount = 0;
+    CanvasFrame batch, frame;
+    beginFrame();
+    while (reader.nextJournal()) {
+        // each journal refers to the ids live when it started
+        m_idTable.clear();
+        for (const auto& idPath : reader.ids()) {
+            NameIndexTuple packedId;
+            LocalProp* prop = resolveLocalPath(idPath.path.constData(), idPath.path.size(), packedId);
+            if (!prop) {
+                qWarning() << "journal id of" << idPath.path << "ignored: the property name table is full";
+                continue;
+            }
+
+            const bool bound = LocalProp::isPackedName(packedId.name) ?
+                        m_idTable.insertPacked(idPath.id, prop, packedId.name, packedId.index) :
+                        m_idTable.insert(idPath.id, prop);
+            if (!bound) {
+                qWarning() << "journal has a duplicate or invalid id:" << idPath.path << idPath.id;
+            }
+        }
+
+        // merged as when frames queue up live, so replaying costs a pass
+        // per property changed, rather than per frame journaled
+        bool haveBatch = false;
+        while (reader.nextFrame(haveBatch ? frame : batch)) {
+            ++frameCount;
+            if (!haveBatch) {
+                haveBatch = true;
+                m_coalescer.begin(&batch);
+            } else if (!m_coalescer.merge(frame)) {
+                m_coalescer.finish();
+                applyFrame(batch);
+                std::swap(batch, frame);
+                m_coalescer.begin(&batch);
+            }
+        }
+
+        if (haveBatch) {
+            m_coalescer.finish();
+            applyFrame(batch);
+        }
+    }
+    endFrame();
+    m_coalescer.takeCoalescedCount(); // not values the display missed
+
+    // the ids belong to a session which is over
+    m_idTable.clear();
+    if (m_publishVersions) {
+        m_publisher.publish(m_localPropertyRoot);
+    }
+
+    qDebug() << "restored" << m_webSocketUrl << m_rootPropertyPath << "from its journal, replaying"
+             << frameCount << "frames";
+    emit updated();
+    return true;
 }
 
 void CanvasConnection::restoreSnapshot(QDataStream &ds)
 {
     ds >> m_webSocketUrl >> m_rootPropertyPath >> m_destRect;
-    m_localPropertyRoot.reset(LocalProp::restoreFromStream(ds, nullptr));
+    dropPropertyTree();
+    m_localPropertyRoot = LocalProp::restoreFromStream(ds, nullptr, &m_propertyArena);
+    if (m_publishVersions) {
+        m_publisher.publish(m_localPropertyRoot);
+    }
     setStatus(Snapshot);
 
     emit geometryChanged();
@@ -115,7 +367,9 @@ void CanvasConnection::restoreSnapshot(QDataStream &ds)
 void CanvasConnection::reconnect()
 {
     qDebug() << "starting connection attempt to:" << m_webSocketUrl;
-    m_webSocket.open(m_webSocketUrl);
+    m_connectTimer.start();
+    QMetaObject::invokeMethod(m_worker, "open", Qt::QueuedConnection, Q_ARG(QUrl, requestUrl()),
+                              Q_ARG(QByteArray, m_rootPropertyPath));
     setStatus(Connecting);
 }
 
@@ -150,10 +404,17 @@ void CanvasConnection::connectWebSocket(QByteArray hostName, int port)
     wsUrl.setPort(port);
     wsUrl.setPath("/PropertyTreeMirror" + m_rootPropertyPath);
 
+    if (wsUrl != m_webSocketUrl) {
+        // a different canvas, nothing in the current tree can be re-used
+        dropPropertyTree();
+    }
+
     m_webSocketUrl = wsUrl;
     emit webSocketUrlChanged();
 
-    m_webSocket.open(wsUrl);
+    m_connectTimer.start();
+    QMetaObject::invokeMethod(m_worker, "open", Qt::QueuedConnection, Q_ARG(QUrl, requestUrl()),
+                              Q_ARG(QByteArray, m_rootPropertyPath));
     setStatus(Connecting);
 }
 
@@ -169,7 +430,34 @@ QSizeF CanvasConnection::size() const
 
 LocalProp *CanvasConnection::propertyRoot() const
 {
-    return m_localPropertyRoot.get();
+    if (m_snapshot) {
+        const_cast<CanvasConnection*>(this)->materializeSnapshot();
+    }
+
+    return m_localPropertyRoot;
+}
+
+bool CanvasConnection::hasDisplayableTree() const
+{
+    // the initial sync of a new tree is applied silently, and its elements
+    // built once it is complete; a tree kept for a resync is shown meanwhile
+    return propertyRoot() && (!m_initialSync || m_resync);
+}
+
+MemoryUsage CanvasConnection::memoryUsage() const
+{
+    MemoryUsage usage;
+    if (m_localPropertyRoot) {
+        m_localPropertyRoot->addMemoryUsage(usage);
+    }
+
+    usage.reservedBytes = m_propertyArena.reservedBytes();
+    return usage;
+}
+
+QJsonObject CanvasConnection::memoryUsageJson() const
+{
+    return memoryUsage().toJson();
 }
 
 FGQCanvasImageLoader *CanvasConnection::imageLoader() const
@@ -194,104 +482,353 @@ FGQCanvasFontCache *CanvasConnection::fontCache() const
     return m_fontCache;
 }
 
+// nodes which the server announced in a previous session, and which
+// haven't been announced again since reconnecting
+static const int StaleMirrorId = -2;
+
+static void markStale(LocalProp* prop)
+{
+    if (prop->mirrorId() >= 0) {
+        prop->setMirrorId(StaleMirrorId);
+    }
+
+    for (PackedRun* run = prop->packedRuns(); run; run = run->next()) {
+        for (unsigned int i = 0; i < run->size(); ++i) {
+            if (run->mirrorId(i) >= 0) {
+                run->setMirrorId(i, StaleMirrorId);
+            }
+        }
+    }
+
+    for (auto child : prop->children()) {
+        markStale(child);
+    }
+}
+
+static int sweepStale(LocalProp* prop)
+{
+    int removedCount = 0;
+    for (PackedRun* run = prop->packedRuns(); run; run = run->next()) {
+        // backwards, so the run shrinks as its tail goes
+        for (unsigned int i = run->size(); i > 0; --i) {
+            if (run->mirrorId(i - 1) == StaleMirrorId) {
+                prop->removePackedValue(run->name(), i - 1);
+                ++removedCount;
+            }
+        }
+    }
+
+    // copy, since removing modifies the children
+    const std::vector<LocalProp*> children(prop->children().begin(), prop->children().end());
+    for (auto child : children) {
+        if (child->mirrorId() == StaleMirrorId) {
+            prop->removeChild(child);
+            ++removedCount;
+        } else {
+            removedCount += sweepStale(child);
+        }
+    }
+
+    return removedCount;
+}
+
 void CanvasConnection::onWebSocketConnected()
 {
     qDebug() << Q_FUNC_INFO << m_webSocketUrl;
-    m_localPropertyRoot.reset(new LocalProp{nullptr, NameIndexTuple("")});
-    setStatus(Connected);
+    m_idTable.clear();
+    m_initialSyncQuietTimer->stop();
+    m_initialSync = true;
+    m_initialSyncMsec = -1;
+    emit initialSyncChanged();
+
+    if (propertyRoot()) {
+        // reconnecting: keep the tree (and the elements displaying it), and
+        // match the new session's created nodes against it by path. Whatever
+        // isn't announced again is removed once the initial sync completes.
+        m_resync = true;
+        markStale(m_localPropertyRoot);
+        return;
+    }
+
+    m_resync = false;
+    m_localPropertyRoot = LocalProp::createRoot(&m_propertyArena);
+
+    // stay in Connecting until the initial burst has been applied, so
+    // displays don't build elements for it one node at a time
+    m_localPropertyRoot->setNotificationsEnabled(false);
 }
 
-void CanvasConnection::onTextMessageReceived(QString message)
+void CanvasConnection::onFramesAvailable()
 {
-    QJsonDocument json = QJsonDocument::fromJson(message.toUtf8());
-    if (json.isObject()) {
-        // process new nodes
-        QJsonArray created = json.object().value("created").toArray();
-        Q_FOREACH (QJsonValue v, created) {
-            QJsonObject newProp = v.toObject();
+    if (m_applyTimer->isActive()) {
+        return; // already scheduled for the next display frame
+    }
 
-            QByteArray nodePath = newProp.value("path").toString().toUtf8();
-            if (nodePath.indexOf(m_rootPropertyPath) != 0) {
-                qWarning() << "not a property path we are mirroring:" << nodePath;
-                continue;
-            }
+    // apply at most once per display frame; anything arriving meanwhile
+    // is merged into the same batch
+    const qint64 sinceLastApply = m_lastApply.isValid() ? m_lastApply.elapsed() : m_frameIntervalMsec;
+    if (sinceLastApply < m_frameIntervalMsec) {
+        m_applyTimer->start(m_frameIntervalMsec - static_cast<int>(sinceLastApply));
+        return;
+    }
 
-            QByteArray localPath = nodePath.mid(m_rootPropertyPath.size() + 1);
-            LocalProp* newNode = propertyFromPath(localPath);
-            newNode->setPosition(newProp.value("position").toInt());
-            // store in the global dict
-            int propId = newProp.value("id").toInt();
-            if (idPropertyDict.contains(propId)) {
-                qWarning() << "duplicate add of:" << nodePath << "old is" << idPropertyDict.value(propId)->path();
-            } else {
-                idPropertyDict.insert(propId, newNode);
-            }
+    applyPendingFrames();
+}
+
+void CanvasConnection::beginFrame()
+{
+    PropTransaction::begin();
+}
+
+void CanvasConnection::endFrame()
+{
+    PropTransaction::end();
+}
 
-            // set initial value
-            newNode->processChange(newProp.value("value"));
+void CanvasConnection::setPublishVersions(bool publish)
+{
+    m_publishVersions = publish;
+    if (!publish) {
+        m_publisher.clear();
+    } else if (m_localPropertyRoot) {
+        m_publisher.publish(m_localPropertyRoot);
+    }
+}
+
+void CanvasConnection::applyPendingFrames()
+{
+    m_worker->resetNotification();
+    m_lastApply.start();
+
+    // everything taken now is one display frame: observers hear about it
+    // once, however many of their properties changed
+    beginFrame();
+    CanvasFrame* batch = nullptr;
+    CanvasFrame* frame;
+    bool applied = false;
+    bool created = false;
+    while (m_worker->takeFrame(frame)) {
+        if (!batch) {
+            batch = frame;
+            m_coalescer.begin(batch);
+        } else if (m_coalescer.merge(*frame)) {
+            m_worker->recycleFrame(frame);
+        } else {
+            // can't be merged, apply what we have so far first
+            created |= !batch->created.empty();
+            applyBatch(batch);
+            applied = true;
+            batch = frame;
+            m_coalescer.begin(batch);
         }
+    }
 
-        // process removes
-        QJsonArray removed = json.object().value("removed").toArray();
-        Q_FOREACH (QJsonValue v, removed) {
-            int propId = v.toInt();
-            if (!idPropertyDict.contains(propId)) {
-                continue;
-            }
+    if (batch) {
+        created |= !batch->created.empty();
+        applyBatch(batch);
+        applied = true;
+    }
+    endFrame();
 
-            auto prop = idPropertyDict.value(propId);
-            idPropertyDict.remove(propId);
+    m_coalescedValues += m_coalescer.takeCoalescedCount() + m_worker->takeCoalescedCount();
 
-            // depending on the order removes are sent, the LocalProp
-            // may already have been deleted when its parent was removed,
-            // so check if the QPointer is null
-            if (!prop.isNull()) {
-                prop->parent()->removeChild(prop);
-            }
-        } // of removes processing
+    if (!applied || !m_localPropertyRoot) {
+        return;
+    }
 
-        // process changes
-        QJsonArray changed = json.object().value("changed").toArray();
+    if (m_publishVersions) {
+        m_publisher.publish(m_localPropertyRoot);
+    }
 
-        Q_FOREACH (QJsonValue v, changed) {
-            QJsonArray change = v.toArray();
-            if (change.size() != 2) {
-                qWarning() << "malformed change notification";
-                continue;
-            }
+    if (m_initialSync) {
+        // the initial burst may span several messages, and so batches: it
+        // is over once updates follow it, or nothing has for a while
+        if (created) {
+            m_initialSyncQuietTimer->start();
+        } else {
+            finishInitialSync();
+        }
+    } else if (m_journal && m_journal->checkpointDue()) {
+        takeJournalCheckpoint();
+    }
 
-            int propId = change.at(0).toInt();
-            if (!idPropertyDict.contains(propId)) {
-                qWarning() << "ignoring unknown prop ID " << propId;
-                continue;
-            }
+    emit updated();
+}
 
-            LocalProp* lp = idPropertyDict.value(propId);
-            if (lp != nullptr) {
-                lp->processChange(change.at(1));
-            }
-        } // of change processing
+void CanvasConnection::onInitialSyncQuiet()
+{
+    if (!m_initialSync || !m_localPropertyRoot) {
+        return;
     }
 
+    finishInitialSync();
     emit updated();
 }
 
+void CanvasConnection::finishInitialSync()
+{
+    m_initialSyncQuietTimer->stop();
+    m_initialSync = false;
+    if (m_resync) {
+        m_resync = false;
+        const int removedCount = sweepStale(m_localPropertyRoot);
+        qDebug() << "reconnected to" << m_webSocketUrl << "keeping the existing tree, removed"
+                 << removedCount << "stale nodes";
+    }
+
+    m_localPropertyRoot->setNotificationsEnabled(true);
+
+    // displays build their elements from the complete tree here
+    QElapsedTimer buildTimer;
+    buildTimer.start();
+    setStatus(Connected);
+
+    m_initialSyncMsec = m_connectTimer.isValid() ? m_connectTimer.elapsed() : -1;
+    qDebug() << "initial sync of" << m_webSocketUrl << "complete:" << m_idTable.liveCount()
+             << "properties in" << m_initialSyncMsec << "msec, elements built in"
+             << buildTimer.elapsed() << "msec";
+    emit initialSyncChanged();
+
+    // journal from the complete tree, and with this session's ids
+    takeJournalCheckpoint();
+}
+
+void CanvasConnection::applyBatch(CanvasFrame* batch)
+{
+    m_coalescer.finish();
+    if (m_localPropertyRoot) {
+        applyFrame(*batch);
+
+        // the initial sync is journaled as the checkpoint at its end
+        if (m_journal && !m_initialSync) {
+            m_journal->append(*batch);
+        }
+    }
+    m_worker->recycleFrame(batch);
+}
+
+void CanvasConnection::applyFrame(const CanvasFrame& frame)
+{
+    // process new nodes
+    for (const auto& newProp : frame.created) {
+        const QByteArray& nodePath = newProp.path;
+        if (!nodePath.startsWith(m_rootPropertyPath)) {
+            qWarning() << "not a property path we are mirroring:" << nodePath;
+            continue;
+        }
+
+        // resolve the part below our root in place, without copying it
+        const int skip = qMin(m_rootPropertyPath.size() + 1, nodePath.size());
+        const char* localPath = nodePath.constData() + skip;
+        const int localSize = nodePath.size() - skip;
+
+        NameIndexTuple packedId;
+        LocalProp* newNode = resolveLocalPath(localPath, localSize, packedId);
+        if (!newNode) {
+            qWarning() << "ignoring add of:" << nodePath << "- the property name table is full";
+            continue;
+        }
+
+        if (LocalProp::isPackedName(packedId.name)) {
+            newNode->setPackedValue(packedId.name, packedId.index, newProp.value);
+            if (!m_idTable.insertPacked(newProp.id, newNode, packedId.name, packedId.index)) {
+                qWarning() << "duplicate or invalid add of:" << nodePath << newProp.id;
+            }
+            continue;
+        }
+
+        newNode->setPosition(newProp.position);
+        // store in the id table
+        if (!m_idTable.insert(newProp.id, newNode)) {
+            LocalProp* existing = m_idTable.lookup(newProp.id);
+            qWarning() << "duplicate or invalid add of:" << nodePath << newProp.id
+                       << "old is" << (existing ? existing->path() : QByteArray());
+        }
+
+        // set initial value
+        newNode->processChange(newProp.value);
+    }
+
+    // process removes
+    for (int propId : frame.removed) {
+        // depending on the order removes are sent, the LocalProp may
+        // already have been deleted (and its id released) when its
+        // parent was removed
+        const PropertyIdTable::Entry* entry = m_idTable.entry(propId);
+        if (!entry) {
+            continue;
+        }
+
+        if (entry->isPacked()) {
+            const PropertyIdTable::Entry packed = *entry;
+            m_idTable.release(propId);
+            packed.prop->removePackedValue(packed.packedName, packed.packedIndex);
+            continue;
+        }
+
+        LocalProp* prop = entry->prop;
+        m_idTable.releaseSubtree(prop);
+        prop->parent()->removeChild(prop);
+    } // of removes processing
+
+    // process changes
+    for (const auto& change : frame.changed) {
+        const PropertyIdTable::Entry* entry = m_idTable.entry(change.id);
+        if (!entry) {
+            qWarning() << "ignoring unknown prop ID " << change.id;
+            continue;
+        }
+
+        if (entry->isPacked()) {
+            entry->prop->setPackedValue(entry->packedName, entry->packedIndex, change.value);
+        } else {
+            entry->prop->processChange(change.value);
+        }
+    } // of change processing
+}
+
 void CanvasConnection::onWebSocketClosed()
 {
-    if ((m_status == Connected) || (m_status == Connected)) {
+    // frames of the session may still be waiting for the next display
+    // frame: apply them while their ids are valid
+    m_applyTimer->stop();
+    applyPendingFrames();
+
+    if ((m_status == Connected) || (m_status == Connecting)) {
         qDebug() << "saw web-socket closed";
     }
 
-    m_localPropertyRoot.reset();
-    idPropertyDict.clear();
+    // keep the tree, so displays can show the last state and a reconnect
+    // only needs to apply the differences; unless it was never complete
+    if (m_initialSync && !m_resync) {
+        dropPropertyTree();
+    } else if (m_resync) {
+        // what the interrupted resync matched is current, the rest is gone
+        const int removedCount = sweepStale(m_localPropertyRoot);
+        qDebug() << "resync of" << m_webSocketUrl << "interrupted, removed" << removedCount << "stale nodes";
+    }
+    m_initialSyncQuietTimer->stop();
+    m_initialSync = false;
+    m_resync = false;
+    m_idTable.clear();
 
     setStatus(Closed);
 
-    if (m_autoReconnect) {
+    if (m_reconnectAfterOverflow) {
+        // not a network failure: resync straight away
+        m_reconnectAfterOverflow = false;
+        reconnect();
+    } else if (m_autoReconnect) {
         m_reconnectTimer->start();
     }
 }
 
+void CanvasConnection::onWorkerOverflowed()
+{
+    qWarning() << "fell too far behind" << m_webSocketUrl << "- reconnecting to resync";
+    m_reconnectAfterOverflow = true;
+}
+
 void CanvasConnection::setStatus(CanvasConnection::Status newStatus)
 {
     if (newStatus == m_status)
@@ -301,8 +838,55 @@ void CanvasConnection::setStatus(CanvasConnection::Status newStatus)
     emit statusChanged(m_status);
 }
 
-LocalProp *CanvasConnection::propertyFromPath(QByteArray path) const
+void CanvasConnection::dropPropertyTree()
 {
-    return m_localPropertyRoot->getOrCreateWithPath(path);
+    m_idTable.clear();
+    m_publisher.clear();
+    m_snapshot.reset();
+    m_snapshotCanvas = -1;
+    m_localPropertyRoot = nullptr;
+    // nodes aren't deleted one by one: only those with observers or string
+    // values are visited, the rest go with the arena's memory
+    m_propertyArena.release();
+}
+
+LocalProp *CanvasConnection::propertyFromPath(const char* path, int size) const
+{
+    return m_localPropertyRoot->getOrCreateWithPath(path, size);
+}
+
+LocalProp* CanvasConnection::resolveLocalPath(const char* localPath, int localSize,
+                                              NameIndexTuple& packedId) const
+{
+    // runs such as coord[i] are packed into an array on their parent. Null
+    // if a name can't be interned, because the name table is full.
+    const char* leaf = localPath + localSize;
+    while ((leaf > localPath) && (leaf[-1] != '/')) {
+        --leaf;
+    }
+
+    PropPathIterator leafSegment(leaf, static_cast<int>(localPath + localSize - leaf));
+    const NameIndexTuple leafId = leafSegment.next() ? leafSegment.intern() : NameIndexTuple();
+    if (LocalProp::isPackedName(leafId.name)) {
+        packedId = leafId;
+        const int parentSize = qMax(0, static_cast<int>(leaf - localPath) - 1);
+        return propertyFromPath(localPath, parentSize);
+    }
+
+    packedId = NameIndexTuple();
+    return propertyFromPath(localPath, localSize);
+}
+
+QUrl CanvasConnection::requestUrl() const
+{
+    if (!m_preferBinaryFrames) {
+        return m_webSocketUrl;
+    }
+
+    QUrl url = m_webSocketUrl;
+    QUrlQuery query(url);
+    query.addQueryItem("encoding", "binary");
+    url.setQuery(query);
+    return url;
 }
 
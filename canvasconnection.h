@@ -21,18 +21,28 @@
 #include <memory>
 
 #include <QObject>
-#include <QtWebSockets/QWebSocket>
+#include <QThread>
 #include <QJsonObject>
 #include <QUrl>
 #include <QRectF>
-#include <QPointer>
 #include <QTimer>
+#include <QElapsedTimer>
+
+#include "canvasframe.h"
+#include "propertyidtable.h"
+#include "propertyarena.h"
+#include "propertyversion.h"
+#include "memoryusage.h"
+#include "snapshotfile.h"
 
 class LocalProp;
 class QNetworkAccessManager;
 class FGQCanvasImageLoader;
 class FGQCanvasFontCache;
 class QDataStream;
+class CanvasConnectionWorker;
+class SnapshotJournal;
+struct NameIndexTuple;
 
 class CanvasConnection : public QObject
 {
@@ -48,6 +58,9 @@ class CanvasConnection : public QObject
 
     Q_PROPERTY(QUrl webSocketUrl READ webSocketUrl NOTIFY webSocketUrlChanged)
     Q_PROPERTY(QString rootPath READ rootPath NOTIFY rootPathChanged)
+
+    Q_PROPERTY(qint64 coalescedValues READ coalescedValues NOTIFY updated)
+    Q_PROPERTY(qint64 initialSyncMsec READ initialSyncMsec NOTIFY initialSyncChanged)
 public:
     explicit CanvasConnection(QObject *parent = nullptr);
     ~CanvasConnection();
@@ -57,6 +70,28 @@ public:
 
     void setAutoReconnect();
 
+    /**
+     * @brief request binary change frames from the server, instead of JSON
+     * text. Servers which don't support them keep sending JSON, which is
+     * still handled.
+     */
+    void setPreferBinaryFrames(bool binary);
+
+    /**
+     * @brief record every frame received by subsequent connections into
+     * rotating files in dir, see SessionRecorder. An empty dir stops
+     * recording.
+     */
+    void setRecordingDirectory(QString dir);
+
+    /**
+     * @brief keep the last known state of the canvas in dir continuously,
+     * as checkpoints and a journal of the frames applied since (see
+     * SnapshotJournal). Journaling starts once the initial sync is
+     * complete; an empty dir stops it, but leaves the files.
+     */
+    void setJournalDirectory(QString dir);
+
     enum Status
     {
         NotConnected,
@@ -76,9 +111,30 @@ public:
     QJsonObject saveState() const;
     bool restoreState(QJsonObject state);
 
-    void saveSnapshot(QDataStream& ds) const;
+    /**
+     * @brief add the canvas to writer. With bundleAssets, the images and
+     * fonts the tree refers to are added too, so restoring the snapshot
+     * needs neither the network nor the disk cache. Only assets which were
+     * loaded already can be bundled.
+     */
+    void saveSnapshot(SnapshotWriter& writer, bool bundleAssets = false) const;
+
+    /**
+     * @brief restore canvas of a version 2 snapshot. The property tree is
+     * built from the mapped file when first asked for, see propertyRoot().
+     */
+    void restoreSnapshot(SnapshotFile::Ptr file, int canvas);
+
+    /// restore from a version 1 snapshot stream
     void restoreSnapshot(QDataStream &ds);
 
+    /**
+     * @brief restore the last known state journaled into directory (one of
+     * SnapshotJournal::canvasDirectory): its latest checkpoint, with the
+     * journal replayed over it. Returns false if there is no checkpoint.
+     */
+    bool restoreJournal(const QString& directory);
+
     void connectWebSocket(QByteArray hostName, int port);
     QPointF origin() const;
 
@@ -86,6 +142,13 @@ public:
 
     LocalProp* propertyRoot() const;
 
+    /**
+     * @brief whether the tree can be displayed: restored, or kept from an
+     * earlier state while (re)connecting, but not while a new tree is
+     * still being synced
+     */
+    bool hasDisplayableTree() const;
+
     QUrl webSocketUrl() const
     {
         return m_webSocketUrl;
@@ -100,6 +163,59 @@ public:
 
     FGQCanvasFontCache* fontCache() const;
 
+    /**
+     * @brief number of property values which were never applied, because a
+     * newer value for the same property arrived before the display caught
+     * up (or the node was created and removed meanwhile)
+     */
+    qint64 coalescedValues() const
+    {
+        return m_coalescedValues;
+    }
+
+    /**
+     * @brief time from requesting the connection until the first complete
+     * frame was applied and the elements were built, or -1 if that hasn't
+     * happened yet
+     */
+    qint64 initialSyncMsec() const
+    {
+        return m_initialSyncMsec;
+    }
+
+    /**
+     * @brief bracket a batch of changes to the property tree: value
+     * notifications are collected until endFrame(), then delivered once
+     * per observer (see PropTransaction). Frames received from the server
+     * are applied this way; use it for local changes spanning several
+     * properties too.
+     */
+    void beginFrame();
+    void endFrame();
+
+    /**
+     * @brief publish an immutable version of the tree after each applied
+     * frame, for readers on other threads. Off by default, since building
+     * the first version copies the whole tree.
+     */
+    void setPublishVersions(bool publish);
+
+    /// the latest published version, or null. Callable from any thread.
+    PropTreeVersionPtr currentVersion() const
+    {
+        return m_publisher.current();
+    }
+
+    /**
+     * @brief memory held by the property tree, including what its arena
+     * keeps for re-use. Elements belong to the displays: see
+     * CanvasDisplay::memoryUsage() for those.
+     */
+    MemoryUsage memoryUsage() const;
+
+    /// memoryUsage() for QML
+    Q_INVOKABLE QJsonObject memoryUsageJson() const;
+
 public Q_SLOTS:
     void reconnect();
 
@@ -120,26 +236,67 @@ signals:
     void webSocketUrlChanged();
 
     void updated();
+
+    void initialSyncChanged();
 private Q_SLOTS:
     void onWebSocketConnected();
-    void onTextMessageReceived(QString message);
+    void onFramesAvailable();
+    void applyPendingFrames();
     void onWebSocketClosed();
+    void onWorkerOverflowed();
+    void onInitialSyncQuiet();
 
 private:
     void setStatus(Status newStatus);
-    LocalProp *propertyFromPath(QByteArray path) const;
+    LocalProp *propertyFromPath(const char* path, int size) const;
+    void dropPropertyTree();
+    LocalProp* resolveLocalPath(const char* localPath, int localSize, NameIndexTuple& packedId) const;
+    void takeJournalCheckpoint();
+    void addSnapshotAssets(SnapshotWriter& writer, const LocalProp* prop) const;
+    void materializeSnapshot();
+    QUrl requestUrl() const;
+
+    void applyFrame(const CanvasFrame& frame);
+    void applyBatch(CanvasFrame* batch);
+    void finishInitialSync();
 
     QUrl m_webSocketUrl;
     QByteArray m_rootPropertyPath;
     QRectF m_destRect;
 
-    QWebSocket m_webSocket;
+    QThread m_workerThread;
+    CanvasConnectionWorker* m_worker = nullptr;
     QNetworkAccessManager* m_netAccess = nullptr;
     QTimer* m_reconnectTimer = nullptr;
     bool m_autoReconnect = false;
-
-    std::unique_ptr<LocalProp> m_localPropertyRoot;
-    QHash<int, QPointer<LocalProp>> idPropertyDict;
+    bool m_reconnectAfterOverflow = false;
+    bool m_preferBinaryFrames = false;
+
+    // frames are applied at most once per display refresh
+    QTimer* m_applyTimer = nullptr;
+    QElapsedTimer m_lastApply;
+    int m_frameIntervalMsec = 16;
+    CanvasFrameCoalescer m_coalescer;
+    qint64 m_coalescedValues = 0;
+
+    // the initial burst of created nodes is applied silently, and elements
+    // built for it in one pass once it is complete
+    bool m_initialSync = false;
+    bool m_resync = false; ///< initial sync is being matched against a kept tree
+    QTimer* m_initialSyncQuietTimer = nullptr; ///< ends a sync nothing follows
+    QElapsedTimer m_connectTimer;
+    qint64 m_initialSyncMsec = -1;
+
+    // the tree lives in the arena, and is dropped with it in one go
+    PropertyArena m_propertyArena;
+    LocalProp* m_localPropertyRoot = nullptr;
+    PropTreePublisher m_publisher;
+    SnapshotFile::Ptr m_snapshot; ///< restored from, until the tree is built
+    int m_snapshotCanvas = -1;
+    bool m_publishVersions = false;
+    QString m_journalDirectory;
+    std::unique_ptr<SnapshotJournal> m_journal;
+    PropertyIdTable m_idTable;
     Status m_status = NotConnected;
 
     mutable FGQCanvasImageLoader* m_imageLoader = nullptr;
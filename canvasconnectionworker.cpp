@@ -0,0 +1,243 @@
+//
+// Copyright (C) 2026 The fgqcanvas contributors
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as
+// published by the Free Software Foundation; either version 2 of the
+// License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+
+#include "canvasconnectionworker.h"
+
+#include <QDebug>
+#include <QtWebSockets/QWebSocket>
+
+#include "canvasframecodec.h"
+#include "sessionrecorder.h"
+
+// kept small so a stalled GUI thread sees recent state once it catches up:
+// anything beyond this is merged rather than queued
+static const size_t FrameQueueCapacity = 8;
+
+// frames which can't be merged (structural changes) still queue up behind
+// a stalled GUI thread; beyond this many, the session is dropped instead,
+// and CanvasConnection re-opens it to resync against the kept tree
+static const size_t MaxOverflowFrames = 1024;
+
+CanvasConnectionWorker::CanvasConnectionWorker(QObject* pr) :
+    QObject(pr),
+    m_webSocket(new QWebSocket(QString(), QWebSocketProtocol::VersionLatest, this)),
+    m_decodedFrames(FrameQueueCapacity),
+    m_recycledFrames(FrameQueueCapacity),
+    m_coalescedCount(0),
+    m_notifyPending(false),
+    m_hasOverflow(false)
+{
+    connect(m_webSocket, &QWebSocket::connected, this, &CanvasConnectionWorker::connected);
+    connect(m_webSocket, &QWebSocket::disconnected, this, &CanvasConnectionWorker::disconnected);
+    connect(m_webSocket, &QWebSocket::textMessageReceived,
+            this, &CanvasConnectionWorker::onTextMessageReceived);
+    connect(m_webSocket, &QWebSocket::binaryMessageReceived,
+            this, &CanvasConnectionWorker::onBinaryMessageReceived);
+}
+
+CanvasConnectionWorker::~CanvasConnectionWorker()
+{
+    CanvasFrame* frame;
+    while (m_decodedFrames.pop(frame)) {
+        delete frame;
+    }
+
+    while (m_recycledFrames.pop(frame)) {
+        delete frame;
+    }
+
+    for (auto f : m_overflowFrames) {
+        delete f;
+    }
+
+    for (auto f : m_spareFrames) {
+        delete f;
+    }
+}
+
+void CanvasConnectionWorker::resetNotification()
+{
+    m_notifyPending = false;
+
+    // the GUI is about to drain the queue, so there will be room for
+    // frames which didn't fit earlier
+    if (m_hasOverflow) {
+        QMetaObject::invokeMethod(this, "flushOverflowFrames", Qt::QueuedConnection);
+    }
+}
+
+bool CanvasConnectionWorker::takeFrame(CanvasFrame*& frame)
+{
+    return m_decodedFrames.pop(frame);
+}
+
+void CanvasConnectionWorker::recycleFrame(CanvasFrame* frame)
+{
+    if (!m_recycledFrames.push(frame)) {
+        delete frame;
+    }
+}
+
+qint64 CanvasConnectionWorker::takeCoalescedCount()
+{
+    return m_coalescedCount.exchange(0);
+}
+
+void CanvasConnectionWorker::open(QUrl url, QByteArray rootPath)
+{
+    m_url = url;
+    m_rootPath = rootPath;
+
+    // each connection attempt is recorded as a session of its own
+    m_recorder.reset();
+    if (!m_recordingDirectory.isEmpty()) {
+        SessionRecorder::Settings settings;
+        settings.directory = m_recordingDirectory;
+        m_recorder.reset(new SessionRecorder(url, rootPath, settings));
+    }
+
+    m_webSocket->open(url);
+}
+
+void CanvasConnectionWorker::close()
+{
+    m_webSocket->close();
+    m_recorder.reset();
+}
+
+void CanvasConnectionWorker::setRecordingDirectory(QString dir)
+{
+    m_recordingDirectory = dir;
+
+    // a recording starts with the next connection, so that it includes
+    // the initial sync and can be replayed on its own
+    if (dir.isEmpty()) {
+        m_recorder.reset();
+    }
+}
+
+void CanvasConnectionWorker::onTextMessageReceived(QString message)
+{
+    if (m_recorder) {
+        m_recorder->recordText(message);
+    }
+
+    CanvasFrame* frame = allocateFrame();
+    if (!decodeJsonFrame(message, *frame)) {
+        qWarning() << "malformed JSON frame from" << m_url;
+        delete frame;
+        return;
+    }
+
+    publishFrame(frame);
+}
+
+void CanvasConnectionWorker::onBinaryMessageReceived(QByteArray message)
+{
+    if (m_recorder) {
+        m_recorder->recordBinary(message);
+    }
+
+    CanvasFrame* frame = allocateFrame();
+    if (!decodeBinaryFrame(message, *frame)) {
+        qWarning() << "malformed binary frame from" << m_url;
+        delete frame;
+        return;
+    }
+
+    publishFrame(frame);
+}
+
+CanvasFrame* CanvasConnectionWorker::allocateFrame()
+{
+    CanvasFrame* frame;
+    if (!m_spareFrames.empty()) {
+        frame = m_spareFrames.back();
+        m_spareFrames.pop_back();
+        return frame;
+    }
+
+    if (m_recycledFrames.pop(frame)) {
+        return frame;
+    }
+
+    return new CanvasFrame;
+}
+
+void CanvasConnectionWorker::publishFrame(CanvasFrame* frame)
+{
+    if (!m_overflowFrames.empty()) {
+        // the queue is full: fold this frame into the newest waiting one
+        if (m_coalescer.target() != m_overflowFrames.back()) {
+            m_coalescer.begin(m_overflowFrames.back());
+        }
+
+        const bool merged = m_coalescer.merge(*frame);
+        m_coalescedCount += m_coalescer.takeCoalescedCount();
+        if (merged) {
+            frame->clear();
+            m_spareFrames.push_back(frame);
+            flushOverflowFrames();
+            return;
+        }
+
+        m_coalescer.finish();
+    }
+
+    if (m_overflowFrames.size() >= MaxOverflowFrames) {
+        qWarning() << "GUI thread fell too far behind" << m_url << "- dropping the connection";
+        m_coalescer.finish();
+        for (auto f : m_overflowFrames) {
+            delete f;
+        }
+        m_overflowFrames.clear();
+        m_hasOverflow = false;
+        delete frame;
+        emit overflowed();
+        m_webSocket->abort();
+        return;
+    }
+
+    // preserve ordering: anything already waiting goes first
+    m_overflowFrames.push_back(frame);
+    flushOverflowFrames();
+}
+
+void CanvasConnectionWorker::flushOverflowFrames()
+{
+    bool pushed = false;
+    do {
+        while (!m_overflowFrames.empty() && (m_decodedFrames.size() < m_decodedFrames.capacity())) {
+            CanvasFrame* frame = m_overflowFrames.front();
+            if (frame == m_coalescer.target()) {
+                m_coalescer.finish();
+            }
+
+            // can't fail: only this thread pushes, and there is room
+            m_decodedFrames.push(frame);
+            m_overflowFrames.pop_front();
+            pushed = true;
+        }
+
+        m_hasOverflow = !m_overflowFrames.empty();
+        // if the GUI drained the queue before seeing the flag, go again
+    } while (m_hasOverflow && (m_decodedFrames.size() < m_decodedFrames.capacity()));
+
+    if (pushed && !m_notifyPending.exchange(true)) {
+        emit framesAvailable();
+    }
+}
@@ -0,0 +1,108 @@
+//
+// Copyright (C) 2026 The fgqcanvas contributors
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as
+// published by the Free Software Foundation; either version 2 of the
+// License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+
+#ifndef CANVASCONNECTIONWORKER_H
+#define CANVASCONNECTIONWORKER_H
+
+#include <atomic>
+#include <deque>
+#include <memory>
+#include <vector>
+
+#include <QObject>
+#include <QUrl>
+
+#include "spscqueue.h"
+#include "canvasframe.h"
+
+class QWebSocket;
+class SessionRecorder;
+
+/**
+ * @brief Owns the web-socket of a CanvasConnection, and lives on its own
+ * thread. Incoming frames are decoded there into CanvasFrames and handed to
+ * the GUI thread through a lock-free queue; applied frames come back through
+ * a second queue to be re-used. When the GUI thread falls behind and the
+ * queue fills, further frames are coalesced into the newest waiting one, so
+ * the backlog stays bounded however long the stall lasts. Frames which can't
+ * be merged still queue up; if too many do, the connection is dropped and
+ * overflowed() emitted, so the owner can re-open it to resync.
+ */
+class CanvasConnectionWorker : public QObject
+{
+    Q_OBJECT
+public:
+    explicit CanvasConnectionWorker(QObject* pr = nullptr);
+    ~CanvasConnectionWorker();
+
+    // the following are called from the GUI (consumer) thread
+
+    /// call before draining, so frames pushed meanwhile re-notify
+    void resetNotification();
+
+    bool takeFrame(CanvasFrame*& frame);
+
+    /// return an applied frame, to be re-used for decoding
+    void recycleFrame(CanvasFrame* frame);
+
+    /// number of values dropped by coalescing since the last call
+    qint64 takeCoalescedCount();
+
+public Q_SLOTS:
+    void open(QUrl url, QByteArray rootPath);
+    void close();
+
+    /// record the frames of subsequent connections into dir, or stop if empty
+    void setRecordingDirectory(QString dir);
+
+signals:
+    void connected();
+    void disconnected();
+
+    /// emitted once when frames become available, until resetNotification()
+    void framesAvailable();
+
+    /// the GUI thread fell too far behind, and the session was dropped:
+    /// disconnected() follows
+    void overflowed();
+
+private Q_SLOTS:
+    void onTextMessageReceived(QString message);
+    void onBinaryMessageReceived(QByteArray message);
+    void flushOverflowFrames();
+
+private:
+    CanvasFrame* allocateFrame();
+    void publishFrame(CanvasFrame* frame);
+
+    QWebSocket* m_webSocket;
+    QUrl m_url;
+    QByteArray m_rootPath;
+    QString m_recordingDirectory;
+    std::unique_ptr<SessionRecorder> m_recorder;
+
+    SpscQueue<CanvasFrame*> m_decodedFrames;
+    SpscQueue<CanvasFrame*> m_recycledFrames;
+    std::deque<CanvasFrame*> m_overflowFrames; ///< decoded, waiting for queue space
+    std::vector<CanvasFrame*> m_spareFrames; ///< emptied by coalescing, owned by this thread
+    CanvasFrameCoalescer m_coalescer;
+    std::atomic<qint64> m_coalescedCount;
+    std::atomic<bool> m_notifyPending;
+    std::atomic<bool> m_hasOverflow;
+};
+
+#endif // CANVASCONNECTIONWORKER_H
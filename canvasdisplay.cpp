@@ -18,6 +18,8 @@
 #include "canvasdisplay.h"
 
 #include <QDebug>
+#include <QFile>
+#include <QJsonDocument>
 #include <QQuickItem>
 
 #include "canvasconnection.h"
@@ -40,7 +42,9 @@ CanvasDisplay::~CanvasDisplay()
 
 void CanvasDisplay::updatePolish()
 {
-    m_rootElement->polish();
+    if (m_rootElement) {
+        m_rootElement->polish();
+    }
 }
 
 void CanvasDisplay::geometryChanged(const QRectF &newGeometry, const QRectF &)
@@ -83,6 +87,45 @@ void CanvasDisplay::setCanvas(CanvasConnection *canvas)
 
 }
 
+MemoryUsage CanvasDisplay::memoryUsage() const
+{
+    MemoryUsage usage;
+    if (m_rootElement) {
+        m_rootElement->addMemoryUsage(usage);
+        m_rootElement->property()->addMemoryUsage(usage);
+    }
+
+    return usage;
+}
+
+QJsonObject CanvasDisplay::memoryUsageJson() const
+{
+    return memoryUsage().toJson();
+}
+
+bool CanvasDisplay::dumpMemoryUsage(QString fileName) const
+{
+    QJsonObject json;
+    if (m_connection) {
+        json.insert("url", m_connection->webSocketUrl().toString());
+        json.insert("rootPath", m_connection->rootPath());
+        json.insert("connection", m_connection->memoryUsageJson());
+    }
+
+    if (m_rootElement) {
+        json.insert("elements", m_rootElement->memoryUsageReport());
+    }
+
+    QFile f(fileName);
+    if (!f.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        qWarning() << "failed to open" << fileName << "for memory usage:" << f.errorString();
+        return false;
+    }
+
+    f.write(QJsonDocument(json).toJson());
+    return true;
+}
+
 void CanvasDisplay::onConnectionDestroyed()
 {
     m_connection = nullptr;
@@ -93,10 +136,22 @@ void CanvasDisplay::onConnectionDestroyed()
 
 void CanvasDisplay::onConnectionStatusChanged()
 {
-    if ((m_connection->status() == CanvasConnection::Connected) ||
-            (m_connection->status() == CanvasConnection::Snapshot))
-    {
+    // also while connecting, to a tree restored for a warm start
+    if (m_connection->hasDisplayableTree()) {
+        // a reconnect keeps the property tree, and so our elements and items
+        if (m_rootElement && m_elementsRoot.get() && (m_elementsRoot.get() == m_connection->propertyRoot())) {
+            m_rootElement->polish();
+            update();
+            return;
+        }
+
+        delete m_rootItem;
+        // only the elements built here need to see the existing nodes
+        const quint64 observersSince = PropObserverSet::nextSerial();
         m_rootElement.reset(new FGCanvasGroup(nullptr, m_connection->propertyRoot()));
+        m_elementsRoot = m_connection->propertyRoot();
+        m_rootObservers.clear();
+        m_rootObservers.onDestroyed<CanvasDisplay, &CanvasDisplay::onRootPropDestroyed>(m_elementsRoot.get(), this);
         // this is important to elements can discover their connection
         // by walking their parent chain
         m_rootElement->setParent(m_connection);
@@ -104,17 +159,27 @@ void CanvasDisplay::onConnectionStatusChanged()
         connect(m_rootElement.get(), &FGCanvasGroup::canvasSizeChanged,
                 this, &CanvasDisplay::onCanvasSizeChanged);
 
+        // the property tree is complete at this point (restored, or the
+        // initial sync of a connection), so build every element first and
+        // then their quick items in a single pass
+        m_connection->propertyRoot()->recursiveNotifyRestored(observersSince);
         m_rootItem = m_rootElement->createQuickItem(this);
         onCanvasSizeChanged();
 
-        if (m_connection->status() == CanvasConnection::Snapshot) {
-            m_connection->propertyRoot()->recursiveNotifyRestored();
-            m_rootElement->polish();
-            update();
-        }
+        m_rootElement->polish();
+        update();
     }
 }
 
+void CanvasDisplay::onRootPropDestroyed()
+{
+    // the tree was dropped: the root element has deleted its items, and
+    // deletes itself like any other element whose property is destroyed
+    m_rootObservers.clear();
+    m_rootElement.release();
+    m_rootItem = nullptr;
+}
+
 void CanvasDisplay::onConnectionUpdated()
 {
     if (m_rootElement) {
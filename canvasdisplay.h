@@ -20,8 +20,12 @@
 
 #include <memory>
 
+#include <QPointer>
 #include <QQuickItem>
 
+#include "localprop.h"
+#include "memoryusage.h"
+
 class CanvasConnection;
 class FGCanvasGroup;
 class QQuickItem;
@@ -41,6 +45,19 @@ public:
         return m_connection;
     }
 
+    /// memory held by the displayed elements, their items and properties
+    MemoryUsage memoryUsage() const;
+
+    /// memoryUsage() for QML
+    Q_INVOKABLE QJsonObject memoryUsageJson() const;
+
+    /**
+     * @brief write the usage of the connection, and of the elements broken
+     * down by group (see FGCanvasElement::memoryUsageReport), to fileName
+     * as JSON
+     */
+    Q_INVOKABLE bool dumpMemoryUsage(QString fileName) const;
+
 signals:
 
     void canvasChanged(CanvasConnection* canvas);
@@ -64,10 +81,13 @@ private slots:
 
 private:
     void recomputeScaling();
+    void onRootPropDestroyed();
 
     CanvasConnection* m_connection = nullptr;
     std::unique_ptr<FGCanvasGroup> m_rootElement;
-    QQuickItem* m_rootItem = nullptr;
+    LocalPropRef m_elementsRoot; ///< the property tree m_rootElement was built for
+    PropObserverSet m_rootObservers;
+    QPointer<QQuickItem> m_rootItem; ///< deleted by m_rootElement if its tree is dropped
     QSizeF m_sourceSize;
 };
 
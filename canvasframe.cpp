@@ -0,0 +1,167 @@
+//
+// Copyright (C) 2026 The fgqcanvas contributors
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as
+// published by the Free Software Foundation; either version 2 of the
+// License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+
+#include "canvasframe.h"
+
+#include <algorithm>
+
+void CanvasFrame::clear()
+{
+    created.clear();
+    removed.clear();
+    changed.clear();
+}
+
+bool CanvasFrame::isEmpty() const
+{
+    return created.empty() && removed.empty() && changed.empty();
+}
+
+// marks entries dropped by merging, until finish() compacts them away
+static const int DroppedId = -1;
+
+void CanvasFrameCoalescer::begin(CanvasFrame* target)
+{
+    _target = target;
+    _indexed = false; // built lazily, the common case is a single frame
+}
+
+bool CanvasFrameCoalescer::merge(const CanvasFrame& frame)
+{
+    if (!_target) {
+        return false;
+    }
+
+    // a frame applies its creates before its removes, so a create after a
+    // remove in the batch (of the same id, or of a node at or below the
+    // removed one's path, whose path we don't know) would be undone or
+    // re-bind the removed node
+    if (!frame.created.empty() && !_target->removed.empty()) {
+        return false;
+    }
+
+    if (!_indexed) {
+        buildIndex();
+    }
+
+    for (const auto& c : frame.created) {
+        _createdIndex.insert(c.id, static_cast<int>(_target->created.size()));
+        _target->created.push_back(c);
+    }
+
+    for (int id : frame.removed) {
+        dropChange(id);
+        auto it = _createdIndex.find(id);
+        if (it != _createdIndex.end()) {
+            dropCreated(it.value());
+        } else {
+            _target->removed.push_back(id);
+        }
+    }
+
+    for (const auto& c : frame.changed) {
+        auto created = _createdIndex.find(c.id);
+        if (created != _createdIndex.end()) {
+            _target->created[created.value()].value = c.value;
+            ++_coalescedCount;
+            continue;
+        }
+
+        auto existing = _changedIndex.find(c.id);
+        if (existing != _changedIndex.end()) {
+            _target->changed[existing.value()].value = c.value;
+            ++_coalescedCount;
+        } else {
+            _changedIndex.insert(c.id, static_cast<int>(_target->changed.size()));
+            _target->changed.push_back(c);
+        }
+    }
+
+    return true;
+}
+
+void CanvasFrameCoalescer::finish()
+{
+    if (_target && _indexed) {
+        auto& created = _target->created;
+        created.erase(std::remove_if(created.begin(), created.end(),
+                                     [](const CanvasFrame::Created& c) { return c.id == DroppedId; }),
+                      created.end());
+
+        auto& changed = _target->changed;
+        changed.erase(std::remove_if(changed.begin(), changed.end(),
+                                     [](const CanvasFrame::Changed& c) { return c.id == DroppedId; }),
+                      changed.end());
+    }
+
+    _target = nullptr;
+    _indexed = false;
+    _createdIndex.clear();
+    _changedIndex.clear();
+}
+
+qint64 CanvasFrameCoalescer::takeCoalescedCount()
+{
+    const qint64 result = _coalescedCount;
+    _coalescedCount = 0;
+    return result;
+}
+
+void CanvasFrameCoalescer::buildIndex()
+{
+    for (size_t i = 0; i < _target->created.size(); ++i) {
+        _createdIndex.insert(_target->created.at(i).id, static_cast<int>(i));
+    }
+
+    for (size_t i = 0; i < _target->changed.size(); ++i) {
+        _changedIndex.insert(_target->changed.at(i).id, static_cast<int>(i));
+    }
+
+    _indexed = true;
+}
+
+void CanvasFrameCoalescer::dropCreated(int createdIndex)
+{
+    // removing a node deletes its children too, so drop any of them
+    // created in this batch, even if their own removes arrive later
+    const CanvasFrame::Created* node = &_target->created.at(createdIndex);
+    const QByteArray prefix = node->path + '/';
+    for (auto& c : _target->created) {
+        if ((c.id == DroppedId) || ((&c != node) && !c.path.startsWith(prefix))) {
+            continue;
+        }
+
+        _createdIndex.remove(c.id);
+        dropChange(c.id);
+        c.id = DroppedId;
+        c.path.clear();
+        c.value.clear();
+        ++_coalescedCount;
+    }
+}
+
+void CanvasFrameCoalescer::dropChange(int id)
+{
+    auto it = _changedIndex.find(id);
+    if (it == _changedIndex.end()) {
+        return;
+    }
+
+    _target->changed[it.value()].id = DroppedId;
+    _changedIndex.erase(it);
+    ++_coalescedCount;
+}
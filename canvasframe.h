@@ -0,0 +1,102 @@
+//
+// Copyright (C) 2026 The fgqcanvas contributors
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as
+// published by the Free Software Foundation; either version 2 of the
+// License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+
+#ifndef CANVASFRAME_H
+#define CANVASFRAME_H
+
+#include <vector>
+
+#include <QByteArray>
+#include <QHash>
+
+#include "propvalue.h"
+
+/**
+ * @brief One decoded PropertyTreeMirror update: the created, removed and
+ * changed sections of a frame, independent of the wire encoding (JSON text
+ * or binary) it arrived in.
+ */
+struct CanvasFrame
+{
+    struct Created
+    {
+        int id = 0;
+        unsigned int position = 0;
+        QByteArray path; ///< absolute path in the FlightGear property tree
+        PropValue value;
+    };
+
+    struct Changed
+    {
+        int id = 0;
+        PropValue value;
+    };
+
+    std::vector<Created> created;
+    std::vector<int> removed;
+    std::vector<Changed> changed;
+
+    /// empty the frame, but keep the allocated capacity for re-use
+    void clear();
+
+    bool isEmpty() const;
+};
+
+/**
+ * @brief Merges consecutive frames into one, when they queue up faster than
+ * they can be applied. Only the last value per property id is kept, a
+ * change to a node created in the same batch becomes its initial value, and
+ * a node created and then removed within the batch disappears entirely.
+ * Creates following removes start a new batch, as a frame applies its
+ * creates first.
+ * Applying the merged frame leaves the property tree in the same state as
+ * applying the frames one by one.
+ */
+class CanvasFrameCoalescer
+{
+public:
+    /// start a batch, which frames are then merged into
+    void begin(CanvasFrame* target);
+
+    /// returns false if frame can't be merged into the batch, in which case
+    /// the batch should be finished and applied first
+    bool merge(const CanvasFrame& frame);
+
+    /// compact the batch ready for applying, and detach from it
+    void finish();
+
+    CanvasFrame* target() const
+    {
+        return _target;
+    }
+
+    /// number of values dropped by merging since the last call
+    qint64 takeCoalescedCount();
+
+private:
+    void buildIndex();
+    void dropCreated(int createdIndex);
+    void dropChange(int id);
+
+    CanvasFrame* _target = nullptr;
+    bool _indexed = false;
+    QHash<int, int> _createdIndex; ///< id -> index in _target->created
+    QHash<int, int> _changedIndex; ///< id -> index in _target->changed
+    qint64 _coalescedCount = 0;
+};
+
+#endif // CANVASFRAME_H
@@ -0,0 +1,896 @@
+//
+// Copyright (C) 2026 The fgqcanvas contributors
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as
+// published by the Free Software Foundation; either version 2 of the
+// License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+
+#include "canvasframecodec.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+#include <QDebug>
+#include <QHash>
+#include <QVector>
+#include <QtEndian>
+#include <QJsonDocument>
+#include <QJsonArray>
+#include <QJsonObject>
+#include <QJsonValue>
+
+#include "canvasframe.h"
+
+namespace {
+
+enum ValueTag
+{
+    TagNull = 0,
+    TagFalse,
+    TagTrue,
+    TagInt,
+    TagDouble,
+    TagFloat,
+    TagString
+};
+
+void writeVarint(QByteArray& out, quint64 v)
+{
+    while (v >= 0x80) {
+        out.append(static_cast<char>((v & 0x7f) | 0x80));
+        v >>= 7;
+    }
+    out.append(static_cast<char>(v));
+}
+
+void writeBytes(QByteArray& out, const QByteArray& bytes)
+{
+    writeVarint(out, static_cast<quint64>(bytes.size()));
+    out.append(bytes);
+}
+
+void writeValue(QByteArray& out, const PropValue& v)
+{
+    switch (v.type()) {
+    case PropValue::Type::Null:
+        out.append(static_cast<char>(TagNull));
+        return;
+
+    case PropValue::Type::Bool:
+        out.append(static_cast<char>(v.toBool() ? TagTrue : TagFalse));
+        return;
+
+    case PropValue::Type::Int:
+    case PropValue::Type::Double:
+    {
+        const double d = v.toDouble();
+        if ((d == static_cast<double>(static_cast<qint64>(d))) &&
+            (d >= std::numeric_limits<int>::min()) && (d <= std::numeric_limits<int>::max()))
+        {
+            const qint64 i = static_cast<qint64>(d);
+            out.append(static_cast<char>(TagInt));
+            writeVarint(out, (static_cast<quint64>(i) << 1) ^ static_cast<quint64>(i >> 63));
+            return;
+        }
+
+        const float f = static_cast<float>(d);
+        if (static_cast<double>(f) == d) {
+            quint32 bits;
+            memcpy(&bits, &f, sizeof(bits));
+            bits = qToLittleEndian(bits);
+            out.append(static_cast<char>(TagFloat));
+            out.append(reinterpret_cast<const char*>(&bits), sizeof(bits));
+            return;
+        }
+
+        quint64 bits;
+        memcpy(&bits, &d, sizeof(bits));
+        bits = qToLittleEndian(bits);
+        out.append(static_cast<char>(TagDouble));
+        out.append(reinterpret_cast<const char*>(&bits), sizeof(bits));
+        return;
+    }
+
+    case PropValue::Type::String:
+        out.append(static_cast<char>(TagString));
+        writeBytes(out, v.stringRef().toUtf8());
+        return;
+    }
+}
+
+class BinaryReader
+{
+public:
+    BinaryReader(const QByteArray& bytes) :
+        _pos(reinterpret_cast<const uchar*>(bytes.constData())),
+        _end(_pos + bytes.size())
+    {}
+
+    bool readByte(uchar& b)
+    {
+        if (_pos >= _end)
+            return false;
+        b = *_pos++;
+        return true;
+    }
+
+    bool readVarint(quint64& v)
+    {
+        v = 0;
+        for (int shift = 0; shift < 64; shift += 7) {
+            uchar b;
+            if (!readByte(b))
+                return false;
+            v |= static_cast<quint64>(b & 0x7f) << shift;
+            if ((b & 0x80) == 0)
+                return true;
+        }
+        return false; // over-long encoding
+    }
+
+    bool readInt(int& v)
+    {
+        quint64 u;
+        if (!readVarint(u) || (u > static_cast<quint64>(std::numeric_limits<int>::max())))
+            return false;
+        v = static_cast<int>(u);
+        return true;
+    }
+
+    // a count of entries of at least minimumBytes each, which the
+    // remaining input could hold: checked before anything is allocated
+    bool readCount(int& count, int minimumBytes)
+    {
+        return readInt(count) && (count <= ((_end - _pos) / minimumBytes));
+    }
+
+    bool readBytes(const char*& data, int& length)
+    {
+        if (!readInt(length) || (length > (_end - _pos)))
+            return false;
+        data = reinterpret_cast<const char*>(_pos);
+        _pos += length;
+        return true;
+    }
+
+    template <class T>
+    bool readLittleEndian(T& v)
+    {
+        if (static_cast<size_t>(_end - _pos) < sizeof(T))
+            return false;
+        v = qFromLittleEndian<T>(_pos);
+        _pos += sizeof(T);
+        return true;
+    }
+
+    bool readValue(PropValue& v)
+    {
+        uchar tag;
+        if (!readByte(tag))
+            return false;
+
+        switch (tag) {
+        case TagNull:   v = PropValue(); return true;
+        case TagFalse:  v = false; return true;
+        case TagTrue:   v = true; return true;
+        case TagInt: {
+            quint64 u;
+            if (!readVarint(u))
+                return false;
+            v = static_cast<int>(static_cast<qint64>(u >> 1) ^ -static_cast<qint64>(u & 1));
+            return true;
+        }
+
+        case TagDouble: {
+            quint64 bits;
+            if (!readLittleEndian(bits))
+                return false;
+            double d;
+            memcpy(&d, &bits, sizeof(d));
+            v = d;
+            return true;
+        }
+
+        case TagFloat: {
+            quint32 bits;
+            if (!readLittleEndian(bits))
+                return false;
+            float f;
+            memcpy(&f, &bits, sizeof(f));
+            v = static_cast<double>(f);
+            return true;
+        }
+
+        case TagString: {
+            const char* data;
+            int length;
+            if (!readBytes(data, length))
+                return false;
+            v = QString::fromUtf8(data, length);
+            return true;
+        }
+
+        default:
+            return false;
+        }
+    }
+
+    bool atEnd() const
+    {
+        return _pos == _end;
+    }
+
+private:
+    const uchar* _pos;
+    const uchar* _end;
+};
+
+} // of anonymous namespace
+
+QByteArray encodeBinaryFrame(const CanvasFrame& frame)
+{
+    // build the segment string table first
+    QHash<QByteArray, int> segmentIndex;
+    QVector<QByteArray> segments;
+    std::vector<QVector<int>> createdSegments;
+    createdSegments.reserve(frame.created.size());
+
+    for (const auto& c : frame.created) {
+        QVector<int> indices;
+        for (const QByteArray& seg : c.path.split('/')) {
+            if (seg.isEmpty())
+                continue;
+            auto it = segmentIndex.find(seg);
+            if (it == segmentIndex.end()) {
+                it = segmentIndex.insert(seg, segments.size());
+                segments.append(seg);
+            }
+            indices.append(it.value());
+        }
+        createdSegments.push_back(indices);
+    }
+
+    QByteArray out;
+    out.append(static_cast<char>(BinaryFrameVersion));
+
+    writeVarint(out, static_cast<quint64>(segments.size()));
+    for (const QByteArray& seg : segments) {
+        writeBytes(out, seg);
+    }
+
+    writeVarint(out, frame.created.size());
+    for (size_t i = 0; i < frame.created.size(); ++i) {
+        const auto& c = frame.created.at(i);
+        writeVarint(out, static_cast<quint64>(c.id));
+        writeVarint(out, c.position);
+        writeVarint(out, static_cast<quint64>(createdSegments.at(i).size()));
+        for (int index : createdSegments.at(i)) {
+            writeVarint(out, static_cast<quint64>(index));
+        }
+        writeValue(out, c.value);
+    }
+
+    writeVarint(out, frame.removed.size());
+    for (int id : frame.removed) {
+        writeVarint(out, static_cast<quint64>(id));
+    }
+
+    writeVarint(out, frame.changed.size());
+    for (const auto& c : frame.changed) {
+        writeVarint(out, static_cast<quint64>(c.id));
+        writeValue(out, c.value);
+    }
+
+    return out;
+}
+
+bool decodeBinaryFrame(const QByteArray& bytes, CanvasFrame& frame)
+{
+    frame.clear();
+    BinaryReader reader(bytes);
+
+    uchar version;
+    if (!reader.readByte(version) || (version != BinaryFrameVersion))
+        return false;
+
+    int segmentCount;
+    if (!reader.readCount(segmentCount, 1)) // a length
+        return false;
+
+    QVector<QByteArray> segments;
+    segments.reserve(segmentCount);
+    for (int s = 0; s < segmentCount; ++s) {
+        const char* data;
+        int length;
+        if (!reader.readBytes(data, length))
+            return false;
+        segments.append(QByteArray::fromRawData(data, length));
+    }
+
+    int createdCount;
+    if (!reader.readCount(createdCount, 4)) // id, position, path length and a value tag
+        return false;
+
+    frame.created.resize(static_cast<size_t>(createdCount));
+    for (auto& c : frame.created) {
+        int position, pathLength;
+        if (!reader.readInt(c.id) || !reader.readInt(position) || !reader.readInt(pathLength))
+            return false;
+        c.position = static_cast<unsigned int>(position);
+
+        c.path.clear();
+        for (int p = 0; p < pathLength; ++p) {
+            int index;
+            if (!reader.readInt(index) || (index >= segments.size()))
+                return false;
+            c.path += '/';
+            c.path += segments.at(index);
+        }
+
+        if (!reader.readValue(c.value))
+            return false;
+    }
+
+    int removedCount;
+    if (!reader.readCount(removedCount, 1)) // an id
+        return false;
+
+    frame.removed.resize(static_cast<size_t>(removedCount));
+    for (int& id : frame.removed) {
+        if (!reader.readInt(id))
+            return false;
+    }
+
+    int changedCount;
+    if (!reader.readCount(changedCount, 2)) // an id and a value tag
+        return false;
+
+    frame.changed.resize(static_cast<size_t>(changedCount));
+    for (auto& c : frame.changed) {
+        if (!reader.readInt(c.id) || !reader.readValue(c.value))
+            return false;
+    }
+
+    return reader.atEnd();
+}
+
+QByteArray encodeJsonFrame(const CanvasFrame& frame)
+{
+    QJsonObject json;
+    if (!frame.created.empty()) {
+        QJsonArray created;
+        for (const auto& c : frame.created) {
+            QJsonObject newProp;
+            newProp["id"] = c.id;
+            newProp["path"] = QString::fromUtf8(c.path);
+            newProp["position"] = static_cast<int>(c.position);
+            newProp["value"] = QJsonValue::fromVariant(c.value.toVariant());
+            created.append(newProp);
+        }
+        json["created"] = created;
+    }
+
+    if (!frame.removed.empty()) {
+        QJsonArray removed;
+        for (int id : frame.removed) {
+            removed.append(id);
+        }
+        json["removed"] = removed;
+    }
+
+    if (!frame.changed.empty()) {
+        QJsonArray changed;
+        for (const auto& c : frame.changed) {
+            changed.append(QJsonArray{c.id, QJsonValue::fromVariant(c.value.toVariant())});
+        }
+        json["changed"] = changed;
+    }
+
+    return QJsonDocument(json).toJson(QJsonDocument::Compact);
+}
+
+namespace {
+
+// exact powers of ten, for the fast path of number parsing
+const double ExactPowersOfTen[] = {
+    1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+
+QString stringFromSpan(const uchar* begin, const uchar* end)
+{
+    return QString::fromUtf8(reinterpret_cast<const char*>(begin), static_cast<int>(end - begin));
+}
+
+QString stringFromSpan(const ushort* begin, const ushort* end)
+{
+    return QString(reinterpret_cast<const QChar*>(begin), static_cast<int>(end - begin));
+}
+
+/**
+ * Single-pass reader for PropertyTreeMirror JSON frames, which fills a
+ * CanvasFrame directly from the UTF-8 or UTF-16 text without building a
+ * document. Numbers, booleans and ids are decoded in place, so a frame
+ * of numeric changes into a re-used CanvasFrame does not allocate.
+ */
+template <typename Char>
+class StreamingJsonReader
+{
+    static const int MaxSkipDepth = 64;
+
+public:
+    StreamingJsonReader(const Char* begin, const Char* end) :
+        _p(begin),
+        _end(end)
+    {}
+
+    bool readFrame(CanvasFrame& frame)
+    {
+        if (!consume('{'))
+            return false;
+
+        if (tryConsume('}'))
+            return atEnd();
+
+        do {
+            const Char* key;
+            int keyLength;
+            if (!readKey(key, keyLength) || !consume(':'))
+                return false;
+
+            bool ok;
+            if (keyIs(key, keyLength, "changed")) {
+                ok = readChanged(frame);
+            } else if (keyIs(key, keyLength, "created")) {
+                ok = readCreated(frame);
+            } else if (keyIs(key, keyLength, "removed")) {
+                ok = readRemoved(frame);
+            } else {
+                ok = skipValue();
+            }
+
+            if (!ok)
+                return false;
+        } while (tryConsume(','));
+
+        return consume('}') && atEnd();
+    }
+
+private:
+    // nothing but whitespace may follow the frame
+    bool atEnd()
+    {
+        skipWhitespace();
+        return _p == _end;
+    }
+
+    void skipWhitespace()
+    {
+        while ((_p < _end) && ((*_p == ' ') || (*_p == '\n') || (*_p == '\r') || (*_p == '\t'))) {
+            ++_p;
+        }
+    }
+
+    bool peek(char c)
+    {
+        skipWhitespace();
+        return (_p < _end) && (*_p == c);
+    }
+
+    bool tryConsume(char c)
+    {
+        if (!peek(c))
+            return false;
+        ++_p;
+        return true;
+    }
+
+    bool consume(char c)
+    {
+        return tryConsume(c);
+    }
+
+    bool consumeLiteral(const char* lit)
+    {
+        for (; *lit; ++lit, ++_p) {
+            if ((_p >= _end) || (*_p != *lit))
+                return false;
+        }
+        return true;
+    }
+
+    static bool keyIs(const Char* key, int length, const char* lit)
+    {
+        for (int i = 0; i < length; ++i, ++lit) {
+            if ((*lit == 0) || (key[i] != *lit))
+                return false;
+        }
+        return *lit == 0;
+    }
+
+    bool readKey(const Char*& key, int& length)
+    {
+        if (!consume('"'))
+            return false;
+
+        key = _p;
+        while ((_p < _end) && (*_p != '"')) {
+            if ((*_p == '\\') && (++_p >= _end))
+                return false;
+            ++_p;
+        }
+
+        if (_p >= _end)
+            return false;
+
+        length = static_cast<int>(_p - key);
+        ++_p;
+        return true;
+    }
+
+    bool readString(QString* out)
+    {
+        const Char* begin;
+        int length;
+        if (!readKey(begin, length))
+            return false;
+
+        if (!out)
+            return true;
+
+        const Char* end = begin + length;
+        if (std::find(begin, end, '\\') == end) {
+            *out = stringFromSpan(begin, end);
+            return true;
+        }
+
+        // slow path, for strings containing escapes
+        out->clear();
+        const Char* run = begin;
+        for (const Char* c = begin; c < end; ++c) {
+            if (*c != '\\')
+                continue;
+
+            out->append(stringFromSpan(run, c));
+            ++c;
+            switch (*c) {
+            case 'b': out->append(QChar('\b')); break;
+            case 'f': out->append(QChar('\f')); break;
+            case 'n': out->append(QChar('\n')); break;
+            case 'r': out->append(QChar('\r')); break;
+            case 't': out->append(QChar('\t')); break;
+            case 'u': {
+                if ((end - c) < 5)
+                    return false;
+                ushort unit = 0;
+                for (int h = 1; h <= 4; ++h) {
+                    const ushort x = static_cast<ushort>(c[h]);
+                    int nibble;
+                    if ((x >= '0') && (x <= '9'))
+                        nibble = x - '0';
+                    else if ((x >= 'a') && (x <= 'f'))
+                        nibble = x - 'a' + 10;
+                    else if ((x >= 'A') && (x <= 'F'))
+                        nibble = x - 'A' + 10;
+                    else
+                        return false;
+                    unit = static_cast<ushort>((unit << 4) | nibble);
+                }
+                out->append(QChar(unit)); // surrogate pairs arrive as two escapes
+                c += 4;
+                break;
+            }
+            default:
+                // '"', '\\' and '/' stand for themselves
+                out->append(QChar(static_cast<ushort>(*c)));
+                break;
+            }
+            run = c + 1;
+        }
+
+        out->append(stringFromSpan(run, end));
+        return true;
+    }
+
+    bool readNumber(double& out)
+    {
+        skipWhitespace();
+        const Char* begin = _p;
+        const bool negative = (_p < _end) && (*_p == '-');
+        if (negative)
+            ++_p;
+
+        quint64 mantissa = 0;
+        int significantDigits = 0;
+        int exponent = 0;
+        bool truncated = false;
+
+        for (; (_p < _end) && (*_p >= '0') && (*_p <= '9'); ++_p) {
+            if (significantDigits < 19) {
+                mantissa = (mantissa * 10) + (*_p - '0');
+                if (mantissa > 0)
+                    ++significantDigits;
+            } else {
+                ++exponent;
+                truncated = true;
+            }
+        }
+
+        if ((_p < _end) && (*_p == '.')) {
+            for (++_p; (_p < _end) && (*_p >= '0') && (*_p <= '9'); ++_p) {
+                if (significantDigits < 19) {
+                    mantissa = (mantissa * 10) + (*_p - '0');
+                    if (mantissa > 0)
+                        ++significantDigits;
+                    --exponent;
+                } else {
+                    truncated = true;
+                }
+            }
+        }
+
+        if ((_p < _end) && ((*_p == 'e') || (*_p == 'E'))) {
+            ++_p;
+            bool negativeExponent = false;
+            if ((_p < _end) && ((*_p == '-') || (*_p == '+'))) {
+                negativeExponent = (*_p == '-');
+                ++_p;
+            }
+
+            int e = 0;
+            for (; (_p < _end) && (*_p >= '0') && (*_p <= '9'); ++_p) {
+                if (e < 10000)
+                    e = (e * 10) + (*_p - '0');
+            }
+            exponent += negativeExponent ? -e : e;
+        }
+
+        if ((_p == begin) || (negative && (_p == begin + 1)))
+            return false;
+
+        // Clinger's fast path: both the mantissa and the power of ten are
+        // exact doubles, so one multiply or divide rounds correctly.
+        if (!truncated && (mantissa <= (Q_UINT64_C(1) << 53)) && (exponent >= -22) && (exponent <= 22)) {
+            double d = static_cast<double>(mantissa);
+            d = (exponent < 0) ? d / ExactPowersOfTen[-exponent] : d * ExactPowersOfTen[exponent];
+            out = negative ? -d : d;
+            return true;
+        }
+
+        // rare: long or extreme values, defer to the full conversion
+        char buffer[64];
+        const int length = static_cast<int>(_p - begin);
+        if (length >= static_cast<int>(sizeof(buffer)))
+            return false;
+        for (int i = 0; i < length; ++i) {
+            buffer[i] = static_cast<char>(begin[i]);
+        }
+        bool ok;
+        out = QByteArray::fromRawData(buffer, length).toDouble(&ok);
+        return ok;
+    }
+
+    bool readInt(int& out)
+    {
+        double d;
+        // NaN fails every comparison, so is refused here too
+        if (!readNumber(d) || !(d >= std::numeric_limits<int>::min()) ||
+            !(d <= std::numeric_limits<int>::max()) || (d != std::floor(d)))
+        {
+            return false;
+        }
+        out = static_cast<int>(d);
+        return true;
+    }
+
+    bool readValue(PropValue& out)
+    {
+        skipWhitespace();
+        if (_p >= _end)
+            return false;
+
+        switch (*_p) {
+        case '"': {
+            QString s;
+            if (!readString(&s))
+                return false;
+            out = s;
+            return true;
+        }
+
+        case 't':
+            out = true;
+            return consumeLiteral("true");
+
+        case 'f':
+            out = false;
+            return consumeLiteral("false");
+
+        case 'n':
+            out = PropValue();
+            return consumeLiteral("null");
+
+        case '[':
+        case '{':
+            out = PropValue();
+            return skipValue();
+
+        default: {
+            double d;
+            if (!readNumber(d))
+                return false;
+            out = d;
+            return true;
+        }
+        }
+    }
+
+    // values we don't know are skipped recursively: refuse nesting deeper
+    // than any frame has, rather than run out of stack
+    bool skipValue(int depth = 0)
+    {
+        skipWhitespace();
+        if ((_p >= _end) || (depth > MaxSkipDepth))
+            return false;
+
+        if (*_p == '{') {
+            ++_p;
+            if (tryConsume('}'))
+                return true;
+            do {
+                const Char* key;
+                int keyLength;
+                if (!readKey(key, keyLength) || !consume(':') || !skipValue(depth + 1))
+                    return false;
+            } while (tryConsume(','));
+            return consume('}');
+        }
+
+        if (*_p == '[') {
+            ++_p;
+            if (tryConsume(']'))
+                return true;
+            do {
+                if (!skipValue(depth + 1))
+                    return false;
+            } while (tryConsume(','));
+            return consume(']');
+        }
+
+        PropValue ignored;
+        return readValue(ignored);
+    }
+
+    bool readCreated(CanvasFrame& frame)
+    {
+        if (!consume('['))
+            return false;
+        if (tryConsume(']'))
+            return true;
+
+        do {
+            if (!consume('{'))
+                return false;
+
+            frame.created.emplace_back();
+            CanvasFrame::Created& c = frame.created.back();
+            if (tryConsume('}'))
+                continue;
+
+            do {
+                const Char* key;
+                int keyLength;
+                if (!readKey(key, keyLength) || !consume(':'))
+                    return false;
+
+                bool ok;
+                if (keyIs(key, keyLength, "id")) {
+                    ok = readInt(c.id);
+                } else if (keyIs(key, keyLength, "path")) {
+                    QString path;
+                    ok = readString(&path);
+                    c.path = path.toUtf8();
+                } else if (keyIs(key, keyLength, "position")) {
+                    int position;
+                    ok = readInt(position);
+                    c.position = static_cast<unsigned int>(position);
+                } else if (keyIs(key, keyLength, "value")) {
+                    ok = readValue(c.value);
+                } else {
+                    ok = skipValue();
+                }
+
+                if (!ok)
+                    return false;
+            } while (tryConsume(','));
+
+            if (!consume('}'))
+                return false;
+        } while (tryConsume(','));
+
+        return consume(']');
+    }
+
+    bool readRemoved(CanvasFrame& frame)
+    {
+        if (!consume('['))
+            return false;
+        if (tryConsume(']'))
+            return true;
+
+        do {
+            int id;
+            if (!readInt(id))
+                return false;
+            frame.removed.push_back(id);
+        } while (tryConsume(','));
+
+        return consume(']');
+    }
+
+    bool readChanged(CanvasFrame& frame)
+    {
+        if (!consume('['))
+            return false;
+        if (tryConsume(']'))
+            return true;
+
+        do {
+            if (!consume('['))
+                return false;
+
+            frame.changed.emplace_back();
+            CanvasFrame::Changed& c = frame.changed.back();
+            if (!readInt(c.id))
+                return false;
+
+            bool wellFormed = tryConsume(',') && readValue(c.value) && peek(']');
+            if (!wellFormed) {
+                qWarning() << "malformed change notification";
+                frame.changed.pop_back();
+                while (tryConsume(',')) {
+                    if (!skipValue())
+                        return false;
+                }
+            }
+
+            if (!consume(']'))
+                return false;
+        } while (tryConsume(','));
+
+        return consume(']');
+    }
+
+    const Char* _p;
+    const Char* _end;
+};
+
+} // of anonymous namespace
+
+bool decodeJsonFrame(const QByteArray& utf8, CanvasFrame& frame)
+{
+    frame.clear();
+    const uchar* begin = reinterpret_cast<const uchar*>(utf8.constData());
+    StreamingJsonReader<uchar> reader(begin, begin + utf8.size());
+    return reader.readFrame(frame);
+}
+
+bool decodeJsonFrame(const QString& text, CanvasFrame& frame)
+{
+    frame.clear();
+    const ushort* begin = text.utf16();
+    StreamingJsonReader<ushort> reader(begin, begin + text.size());
+    return reader.readFrame(frame);
+}
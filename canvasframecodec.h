@@ -0,0 +1,73 @@
+//
+// Copyright (C) 2026 The fgqcanvas contributors
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as
+// published by the Free Software Foundation; either version 2 of the
+// License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+
+#ifndef CANVASFRAMECODEC_H
+#define CANVASFRAMECODEC_H
+
+#include <QByteArray>
+#include <QString>
+
+struct CanvasFrame;
+
+/**
+ * Binary PropertyTreeMirror frames carry the same created / removed / changed
+ * sections as the JSON text frames, in a compact form. A client asks for them
+ * by adding 'encoding=binary' to the query of the /PropertyTreeMirror URL;
+ * servers which don't understand this keep sending JSON, so clients must
+ * accept both frame types.
+ *
+ * All integers are unsigned LEB128 varints, unless noted. Layout:
+ *
+ *   u8      version (currently 1)
+ *   varint  segment count S, then S x (varint length, UTF-8 bytes)
+ *           - the string table of path segments, eg 'group[2]' or 'tf'
+ *   varint  created count, each:
+ *              varint id, varint position,
+ *              varint segment count, varint string-table index per segment,
+ *              value
+ *   varint  removed count, each: varint id
+ *   varint  changed count, each: varint id, value
+ *
+ * A value is a one byte tag, then the payload:
+ *   0 null, 1 false, 2 true (no payload)
+ *   3 int    - zig-zag varint
+ *   4 double - 8 bytes, little-endian IEEE-754
+ *   5 float  - 4 bytes, little-endian IEEE-754 (used when exact)
+ *   6 string - varint length, UTF-8 bytes
+ */
+
+const int BinaryFrameVersion = 1;
+
+QByteArray encodeBinaryFrame(const CanvasFrame& frame);
+
+/// decode into frame (which is cleared first). Returns false on malformed data.
+bool decodeBinaryFrame(const QByteArray& bytes, CanvasFrame& frame);
+
+QByteArray encodeJsonFrame(const CanvasFrame& frame);
+
+/**
+ * Decode a JSON text frame into frame (which is cleared first), in a single
+ * pass with no intermediate document. Re-using the same CanvasFrame keeps its
+ * capacity, so steady-state frames of numeric changes don't allocate. The
+ * QString overload reads the UTF-16 text as delivered by QWebSocket, without
+ * converting it to UTF-8 first.
+ */
+bool decodeJsonFrame(const QByteArray& utf8, CanvasFrame& frame);
+
+bool decodeJsonFrame(const QString& text, CanvasFrame& frame);
+
+#endif // CANVASFRAMECODEC_H
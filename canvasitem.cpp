@@ -16,6 +16,7 @@
 // Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
 
 #include "canvasitem.h"
+#include "memoryusage.h"
 
 #include <QMatrix4x4>
 #include <QSGClipNode>
@@ -74,6 +75,13 @@ void CanvasItem::clearClip()
     update();
 }
 
+void CanvasItem::addMemoryUsage(MemoryUsage& usage) const
+{
+    usage.itemCount++;
+    usage.signalConnectionCount += MemoryUsage::signalConnections(metaObject(),
+        [this](const char* signal) { return receivers(signal); });
+}
+
 QSGNode *CanvasItem::updatePaintNode(QSGNode *oldNode, QQuickItem::UpdatePaintNodeData *d)
 {
     QSGNode* realOldNode = oldNode;
@@ -23,6 +23,7 @@
 
 class LocalTransform;
 class QSGClipNode;
+struct MemoryUsage;
 
 class CanvasItem : public QQuickItem
 {
@@ -39,6 +40,9 @@ public:
     void clearClip();
 
     QSGNode* updatePaintNode(QSGNode *, UpdatePaintNodeData *) override final;
+
+    /// add this item, its connections and any geometry it caches to usage
+    virtual void addMemoryUsage(MemoryUsage& usage) const;
 signals:
 
 public slots:
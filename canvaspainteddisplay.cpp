@@ -92,11 +92,19 @@ void CanvasPaintedDisplay::onConnectionDestroyed()
 
 void CanvasPaintedDisplay::onConnectionStatusChanged()
 {
-    if ((m_connection->status() == CanvasConnection::Connected) ||
-        (m_connection->status() == CanvasConnection::Snapshot))
-    {
-        buildElements();
-    } else {
+    // a reconnect keeps the property tree, and so our elements
+    const bool elementsValid = m_rootElement && m_elementsRoot.get()
+            && (m_elementsRoot.get() == m_connection->propertyRoot());
+
+    // also while connecting, to a tree restored for a warm start
+    if (m_connection->hasDisplayableTree()) {
+        if (elementsValid) {
+            m_rootElement->polish();
+            update();
+        } else {
+            buildElements();
+        }
+    } else if (!elementsValid) {
         if (m_rootElement) {
             qDebug() << Q_FUNC_INFO << "clearing root element";
             delete m_rootElement;
@@ -109,7 +117,11 @@ void CanvasPaintedDisplay::onConnectionStatusChanged()
 void CanvasPaintedDisplay::buildElements()
 {
     qDebug() << Q_FUNC_INFO;
+    delete m_rootElement;
+    // only the elements built here need to see the existing nodes
+    const quint64 observersSince = PropObserverSet::nextSerial();
     m_rootElement = new FGCanvasGroup(nullptr, m_connection->propertyRoot());
+    m_elementsRoot = m_connection->propertyRoot();
     // this is important to elements can discover their connection
     // by walking their parent chain
     m_rootElement->setParent(m_connection);
@@ -119,7 +131,7 @@ void CanvasPaintedDisplay::buildElements()
 
     onCanvasSizeChanged();
 
-    m_connection->propertyRoot()->recursiveNotifyRestored();
+    m_connection->propertyRoot()->recursiveNotifyRestored(observersSince);
     m_rootElement->polish();
     update();
 }
@@ -23,6 +23,8 @@
 #include <QQuickPaintedItem>
 #include <QPointer>
 
+#include "localprop.h"
+
 class CanvasConnection;
 class FGCanvasGroup;
 class QQuickItem;
@@ -69,6 +71,7 @@ private:
 
     CanvasConnection* m_connection = nullptr;
     QPointer<FGCanvasGroup> m_rootElement;
+    LocalPropRef m_elementsRoot; ///< the property tree m_rootElement was built for
    // QQuickItem* m_rootItem = nullptr;
     QSizeF m_sourceSize;
 };
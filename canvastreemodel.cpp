@@ -66,7 +66,7 @@ QVariant CanvasTreeModel::data(const QModelIndex &index, int role) const
 
     switch (role) {
     case Qt::DisplayRole:
-        return e->property()->value("id", QVariant("<noid>"));
+        return e->property()->value("id", "<noid>").toVariant();
 
     case Qt::CheckStateRole:
         return e->property()->value("visible", true).toBool() ? Qt::Checked : Qt::Unchecked;
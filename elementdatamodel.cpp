@@ -61,7 +61,7 @@ QVariant ElementDataModel::data(const QModelIndex &index, int role) const
             return m_element->property()->position();
         }
 
-        return m_element->property()->value(key.constData(), QVariant());
+        return m_element->property()->value(key.constData(), PropValue()).toVariant();
     }
 
     return QVariant();
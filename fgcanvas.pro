@@ -10,6 +10,14 @@ SOURCES += main.cpp\
     fgcanvaselement.cpp \
     fgcanvaspaintcontext.cpp \
     localprop.cpp \
+    nameatom.cpp \
+    propvalue.cpp \
+    propertyarena.cpp \
+    propertyversion.cpp \
+    memoryusage.cpp \
+    snapshotfile.cpp \
+    snapshotcompression.cpp \
+    snapshotjournal.cpp \
     fgcanvaspath.cpp \
     fgcanvastext.cpp \
     fgqcanvasmap.cpp \
@@ -21,7 +29,12 @@ SOURCES += main.cpp\
     applicationcontroller.cpp \
     canvasdisplay.cpp \
     canvaspainteddisplay.cpp \
-    jsonutils.cpp
+    jsonutils.cpp \
+    canvasframe.cpp \
+    canvasframecodec.cpp \
+    canvasconnectionworker.cpp \
+    propertyidtable.cpp \
+    sessionrecorder.cpp
 
 
 HEADERS +=  \
@@ -29,6 +42,14 @@ HEADERS +=  \
     fgcanvaselement.h \
     fgcanvaspaintcontext.h \
     localprop.h \
+    nameatom.h \
+    propvalue.h \
+    propertyarena.h \
+    propertyversion.h \
+    memoryusage.h \
+    snapshotfile.h \
+    snapshotcompression.h \
+    snapshotjournal.h \
     fgcanvaspath.h \
     fgcanvastext.h \
     fgqcanvasmap.h \
@@ -40,7 +61,13 @@ HEADERS +=  \
     fgqcanvasfontcache.h \
     fgqcanvasimageloader.h \
     canvaspainteddisplay.h \
-    jsonutils.h
+    jsonutils.h \
+    canvasframe.h \
+    canvasframecodec.h \
+    canvasconnectionworker.h \
+    spscqueue.h \
+    propertyidtable.h \
+    sessionrecorder.h
 
 RESOURCES += \
     fgqcanvas_resources.qrc
@@ -22,6 +22,7 @@
 #include "fgcanvasgroup.h"
 #include "canvasitem.h"
 #include "canvasconnection.h"
+#include "memoryusage.h"
 
 #include <QDebug>
 #include <QPainter>
@@ -29,13 +30,15 @@
 #include <QRegularExpressionMatch>
 #include <QMatrix4x4>
 
+static const PropPath ClipPath("clip");
+static const PropPath ClipFramePath("clip-frame");
+
 QTransform qTransformFromCanvas(LocalProp* prop)
 {
     double m[6] = { 1.0, 0.0, 0.0, 1.0, 0.0, 0.0 }; // identity matrix
-    for (unsigned int i =0; i< 6; ++i) {
-        LocalProp* mProp =  prop->getOrCreateChildWithNameAndIndex(NameIndexTuple("m", i));
-        if (!mProp->value().isNull()) {
-            m[i] = mProp->value().toDouble();
+    for (LocalProp* mProp : prop->childrenNamed(PropName::M)) {
+        if ((mProp->index() < 6) && !mProp->value().isNull()) {
+            m[mProp->index()] = mProp->value().toDouble();
         }
     }
 
@@ -44,16 +47,20 @@ QTransform qTransformFromCanvas(LocalProp* prop)
                       m[4], m[5], 1.0);
 }
 
-bool FGCanvasElement::isStyleProperty(QByteArray name)
+bool FGCanvasElement::isStyleProperty(NameAtom name)
 {
-    if ((name == "font") || (name == "line-height") || (name == "alignment")
-        || (name == "character-size") || (name == "fill") || (name == "background")
-        || (name == "fill-opacity"))
-    {
+    switch (name) {
+    case PropName::Font:
+    case PropName::LineHeight:
+    case PropName::Alignment:
+    case PropName::CharacterSize:
+    case PropName::Fill:
+    case PropName::Background:
+    case PropName::FillOpacity:
         return true;
+    default:
+        return false;
     }
-
-    return false;
 }
 
 LocalProp *FGCanvasElement::property() const
@@ -87,11 +94,11 @@ FGCanvasElement::FGCanvasElement(FGCanvasGroup* pr, LocalProp* prop) :
     _propertyRoot(prop),
     _parent(pr)
 {
-    connect(prop->getOrCreateWithPath("visible", true), &LocalProp::valueChanged,
-            this, &FGCanvasElement::onVisibleChanged);
-    connect(prop, &LocalProp::childAdded, this, &FGCanvasElement::onChildAdded);
-    connect(prop, &LocalProp::childRemoved, this, &FGCanvasElement::onChildRemoved);
-    connect(prop, &LocalProp::destroyed, this, &FGCanvasElement::onPropDestroyed);
+    _observers.onValueChanged<FGCanvasElement, &FGCanvasElement::onVisibleChanged>(
+        prop->getOrCreateChildWithNameAndIndex(NameIndexTuple(PropName::Visible, 0), true), this);
+    _observers.onChildAdded<FGCanvasElement, &FGCanvasElement::onChildAdded>(prop, this);
+    _observers.onChildRemoved<FGCanvasElement, &FGCanvasElement::onChildRemoved>(prop, this);
+    _observers.onDestroyed<FGCanvasElement, &FGCanvasElement::onPropDestroyed>(prop, this);
 
     if (pr) {
         pr->markChildZIndicesDirty();
@@ -148,8 +155,8 @@ void FGCanvasElement::polish()
     }
 
     if (_styleDirty) {
-        _fillColor = parseColorValue(getCascadedStyle("fill"));
-        const auto opacity = getCascadedStyle("fill-opacity");
+        _fillColor = parseColorValue(getCascadedStyle(PropName::Fill));
+        const auto opacity = getCascadedStyle(PropName::FillOpacity);
         if (!opacity.isNull()) {
             _fillColor.setAlphaF(opacity.toReal());
         }
@@ -166,6 +173,28 @@ void FGCanvasElement::dumpElement()
 
 }
 
+void FGCanvasElement::addMemoryUsage(MemoryUsage& usage) const
+{
+    usage.elementCount++;
+    usage.signalConnectionCount += MemoryUsage::signalConnections(metaObject(),
+        [this](const char* signal) { return receivers(signal); });
+
+    if (quickItem()) {
+        quickItem()->addMemoryUsage(usage);
+    }
+}
+
+QJsonObject FGCanvasElement::memoryUsageReport() const
+{
+    MemoryUsage usage;
+    addMemoryUsage(usage);
+    _propertyRoot->addMemoryUsage(usage);
+
+    QJsonObject json = usage.toJson();
+    json.insert("path", QString::fromUtf8(_propertyRoot->path()));
+    return json;
+}
+
 void FGCanvasElement::paint(FGCanvasPaintContext *context) const
 {
     if (!isVisible()) {
@@ -234,7 +263,7 @@ QTransform FGCanvasElement::combinedTransform() const
     if (_transformsDirty) {
         _combinedTransform.reset();
 
-        for (LocalProp* tfProp : _propertyRoot->childrenWithName("tf")) {
+        for (LocalProp* tfProp : _propertyRoot->childrenNamed(PropName::Tf)) {
             _combinedTransform *= qTransformFromCanvas(tfProp);
         }
 
@@ -283,58 +312,59 @@ CanvasConnection *FGCanvasElement::connection() const
 
 bool FGCanvasElement::onChildAdded(LocalProp *prop)
 {
-    const QByteArray nm = prop->name();
-    if (nm == "tf") {
-        connect(prop, &LocalProp::childAdded, this, &FGCanvasElement::onChildAdded);
-        return true;
-    } else if (nm == "visible") {
+    switch (prop->nameAtom()) {
+    case PropName::Tf:
+        _observers.onChildAdded<FGCanvasElement, &FGCanvasElement::onChildAdded>(prop, this);
         return true;
-    } else if (nm == "tf-rot-index") {
-        // ignored, this is noise from the Nasal SVG parser
+    case PropName::Visible:
         return true;
-    } else if (nm.startsWith("center-offset-")) {
+    case PropName::TfRotIndex:
         // ignored, this is noise from the Nasal SVG parser
         return true;
-    } else if (nm == "center") {
-        connect(prop, &LocalProp::valueChanged, this, &FGCanvasElement::onCenterChanged);
+    case PropName::Center:
+        _observers.onValueChanged<FGCanvasElement, &FGCanvasElement::onCenterChanged>(prop, this);
         return true;
-    } else if (nm == "m") {
-        if ((prop->parent()->name() == "tf") && (prop->parent()->parent() == _propertyRoot)) {
-            connect(prop, &LocalProp::valueChanged, this, &FGCanvasElement::markTransformsDirty);
+    case PropName::M:
+        if ((prop->parent()->nameAtom() == PropName::Tf) && (prop->parent()->parent() == _propertyRoot)) {
+            _observers.onValueChanged<FGCanvasElement, &FGCanvasElement::markTransformsDirty>(prop, this);
             return true;
-        } else {
-            qWarning() << "saw confusing 'm' property" << prop->path();
         }
-    } else if (nm == "m-geo") {
+
+        qWarning() << "saw confusing 'm' property" << prop->path();
+        return false;
+    case PropName::MGeo:
         // ignore for now, we do geo projection server-side
         return true;
-    } else if (nm == "id") {
-        connect(prop, &LocalProp::valueChanged, this, &FGCanvasElement::markSVGIDDirty);
+    case PropName::Id:
+        _observers.onValueChanged<FGCanvasElement, &FGCanvasElement::markSVGIDDirty>(prop, this);
         return true;
-    } else if (nm == "update") {
+    case PropName::Update:
         // disable updates optionally?
         return true;
-    } else if ((nm == "clip") || (nm == "clip-frame")) {
-        connect(prop, &LocalProp::valueChanged, this, &FGCanvasElement::markClipDirty);
+    case PropName::Clip:
+    case PropName::ClipFrame:
+        _observers.onValueChanged<FGCanvasElement, &FGCanvasElement::markClipDirty>(prop, this);
         return true;
-    }
-
-    if (isStyleProperty(nm)) {
-        connect(prop, &LocalProp::valueChanged, this, &FGCanvasElement::markStyleDirty);
+    case PropName::SymbolType:
+        // ignored for now
+        return true;
+    case PropName::LayerType:
+        _observers.onValueChanged<FGCanvasElement, &FGCanvasElement::onLayerTypeChanged>(prop, this);
         return true;
+    case PropName::ZIndex:
+        _observers.onValueChanged<FGCanvasElement, &FGCanvasElement::markZIndexDirty>(prop, this);
+        return true;
+    default:
+        break;
     }
 
-    if (nm == "symbol-type") {
-        // ignored for now
+    if (isStyleProperty(prop->nameAtom())) {
+        _observers.onValueChanged<FGCanvasElement, &FGCanvasElement::markStyleDirty>(prop, this);
         return true;
     }
 
-    if (nm == "layer-type") {
-        connect(prop, &LocalProp::valueChanged, [this](QVariant value)
-        {qDebug() << "layer-type:" << value.toByteArray() << "on" << _propertyRoot->path(); });
-        return true;
-    } else if (nm == "z-index") {
-        connect(prop, &LocalProp::valueChanged, this, &FGCanvasElement::markZIndexDirty);
+    if (prop->name().startsWith("center-offset-")) {
+        // ignored, this is noise from the Nasal SVG parser
         return true;
     }
 
@@ -343,8 +373,8 @@ bool FGCanvasElement::onChildAdded(LocalProp *prop)
 
 bool FGCanvasElement::onChildRemoved(LocalProp *prop)
 {
-    const QByteArray nm = prop->name();
-    if ((nm == "tf") || (nm == "m")) {
+    const NameAtom nm = prop->nameAtom();
+    if ((nm == PropName::Tf) || (nm == PropName::M)) {
         markTransformsDirty();
         return true;
     }
@@ -361,10 +391,10 @@ QColor FGCanvasElement::fillColor() const
     return _fillColor;
 }
 
-void FGCanvasElement::onCenterChanged(QVariant value)
+void FGCanvasElement::onCenterChanged(LocalProp* prop)
 {
-    LocalProp* senderProp = static_cast<LocalProp*>(sender());
-    const unsigned int centerTerm = senderProp->index();
+    const PropValue& value = prop->value();
+    const unsigned int centerTerm = prop->index();
 
     if (centerTerm == 0) {
         _center.setX(value.toReal());
@@ -375,6 +405,11 @@ void FGCanvasElement::onCenterChanged(QVariant value)
     requestPolish();
 }
 
+void FGCanvasElement::onLayerTypeChanged(const PropValue& value)
+{
+    qDebug() << "layer-type:" << value.toByteArray() << "on" << _propertyRoot->path();
+}
+
 void FGCanvasElement::markTransformsDirty()
 {
     _transformsDirty = true;
@@ -384,8 +419,8 @@ void FGCanvasElement::markTransformsDirty()
 void FGCanvasElement::markClipDirty()
 {
     _clipDirty = true;
-    parseCSSClip(_propertyRoot->value("clip", QVariant()).toByteArray());
-    _clipFrame = static_cast<ReferenceFrame>(_propertyRoot->value("clip-frame", 0).toInt());
+    parseCSSClip(_propertyRoot->value(ClipPath, PropValue()).toByteArray());
+    _clipFrame = static_cast<ReferenceFrame>(_propertyRoot->value(ClipFramePath, 0).toInt());
     requestPolish();
 }
 
@@ -407,7 +442,7 @@ double FGCanvasElement::parseCSSValue(QByteArray value) const
     return v;
 }
 
-QColor FGCanvasElement::parseColorValue(QVariant value) const
+QColor FGCanvasElement::parseColorValue(const PropValue& value) const
 {
     QString colorString = value.toString();
     if (colorString.isEmpty() || (colorString == QStringLiteral("none"))) {
@@ -480,7 +515,7 @@ void FGCanvasElement::markStyleDirty()
     // group will cascade
 }
 
-QVariant FGCanvasElement::getCascadedStyle(const char *name, QVariant defaultValue) const
+PropValue FGCanvasElement::getCascadedStyle(NameAtom name, PropValue defaultValue) const
 {
     LocalProp* style = _propertyRoot->childWithNameAndIndex(NameIndexTuple(name, 0));
     if (style) {
@@ -494,18 +529,18 @@ QVariant FGCanvasElement::getCascadedStyle(const char *name, QVariant defaultVal
     return defaultValue;
 }
 
-void FGCanvasElement::markZIndexDirty(QVariant value)
+void FGCanvasElement::markZIndexDirty(const PropValue& value)
 {
     _zIndex = value.toInt();
     _parent->markChildZIndicesDirty();
 }
 
-void FGCanvasElement::markSVGIDDirty(QVariant value)
+void FGCanvasElement::markSVGIDDirty(const PropValue& value)
 {
     _svgElementId = value.toByteArray();
 }
 
-void FGCanvasElement::onVisibleChanged(QVariant value)
+void FGCanvasElement::onVisibleChanged(const PropValue& value)
 {
     _visible = value.toBool();
     requestPolish();
@@ -21,16 +21,18 @@
 #include <QObject>
 #include <QTransform>
 #include <QColor>
-#include <QVariant>
+#include <QJsonObject>
 
 #include <vector>
 
-class LocalProp;
+#include "localprop.h"
+
 class FGCanvasPaintContext;
 class FGCanvasGroup;
 class CanvasItem;
 class QQuickItem;
 class CanvasConnection;
+struct MemoryUsage;
 
 /**
  * Coordinate reference frame (eg. "clip" property)
@@ -63,7 +65,7 @@ public:
 
     CanvasConnection* connection() const;
 
-    static bool isStyleProperty(QByteArray name);
+    static bool isStyleProperty(NameAtom name);
 
     LocalProp* property() const;
 
@@ -79,6 +81,19 @@ public:
     void polish();
 
     virtual void dumpElement() = 0;
+
+    /**
+     * @brief add the memory held by this element, its quick item and any
+     * child elements to usage. Properties aren't included: count them with
+     * LocalProp::addMemoryUsage.
+     */
+    virtual void addMemoryUsage(MemoryUsage& usage) const;
+
+    /**
+     * @brief the usage of this element and its property subtree as JSON,
+     * broken down by child group, for finding the heavy parts of a canvas
+     */
+    virtual QJsonObject memoryUsageReport() const;
 protected:
 
     virtual void doPaint(FGCanvasPaintContext* context) const;
@@ -94,27 +109,30 @@ protected:
 
     QColor fillColor() const;
 
-    QColor parseColorValue(QVariant value) const;
+    QColor parseColorValue(const PropValue& value) const;
 
     virtual void markStyleDirty();
 
-    QVariant getCascadedStyle(const char* name, QVariant defaultValue = QVariant()) const;
+    PropValue getCascadedStyle(NameAtom name, PropValue defaultValue = PropValue()) const;
 
-private slots:
-    void onPropDestroyed();
+    /// property observations of this element, dropped when it's deleted
+    PropObserverSet _observers;
 
 private:
+    void onPropDestroyed();
+
+    void onCenterChanged(LocalProp* prop);
 
-    void onCenterChanged(QVariant value);
+    void onLayerTypeChanged(const PropValue& value);
 
     void markTransformsDirty();
 
-    void markZIndexDirty(QVariant value);
+    void markZIndexDirty(const PropValue& value);
 
-    void onVisibleChanged(QVariant value);
+    void onVisibleChanged(const PropValue& value);
 
     void markClipDirty();
-    void markSVGIDDirty(QVariant value);
+    void markSVGIDDirty(const PropValue& value);
 
 private:
     friend class FGCanvasGroup;
@@ -1,6 +1,7 @@
 #include "fgcanvasgroup.h"
 
 #include <QDebug>
+#include <QJsonArray>
 
 #include "canvasitem.h"
 #include "localprop.h"
@@ -86,7 +87,7 @@ void FGCanvasGroup::doPaint(FGCanvasPaintContext *context) const
 void FGCanvasGroup::doPolish()
 {
     if (_cachedSymbolDirty) {
-        qDebug() << _propertyRoot->path() << "should use symbol cache:" << _propertyRoot->value("symbol-type", QVariant()).toByteArray();
+        qDebug() << _propertyRoot->path() << "should use symbol cache:" << _propertyRoot->value("symbol-type", PropValue()).toByteArray();
         _cachedSymbolDirty = false;
     }
 
@@ -121,36 +122,51 @@ bool FGCanvasGroup::onChildAdded(LocalProp *prop)
         return true;
     }
 
-    const QByteArray nm = prop->name();
-    if (nm == "group") {
+    const NameAtom nm = prop->nameAtom();
+    switch (nm) {
+    case PropName::Group:
         _children.push_back(new FGCanvasGroup(this, prop));
         newChildCount++;
-    } else if (nm == "path") {
+        break;
+    case PropName::Path:
         _children.push_back(new FGCanvasPath(this, prop));
         newChildCount++;
-    } else if (nm == "text") {
+        break;
+    case PropName::Text:
         _children.push_back(new FGCanvasText(this, prop));
         newChildCount++;
-    } else if (nm == "image") {
+        break;
+    case PropName::Image:
         _children.push_back(new FGQCanvasImage(this, prop));
         newChildCount++;
-    } else if (nm == "map") {
+        break;
+    case PropName::Map:
         _children.push_back(new FGQCanvasMap(this, prop));
         newChildCount++;
-    } else if (nm == "symbol-type") {
-        connect(prop, &LocalProp::valueChanged, this, &FGCanvasGroup::markCachedSymbolDirty);
+        break;
+    case PropName::SymbolType:
+        _observers.onValueChanged<FGCanvasGroup, &FGCanvasGroup::markCachedSymbolDirty>(prop, this);
         return true;
+    default:
+        break;
     }
 
     if (isRootGroup) {
         // ignore all of these, handled by the enclosing canvas view
-        if (nm == "size") {
-            connect(prop, &LocalProp::valueChanged, this, &FGCanvasGroup::canvasSizeChanged);
+        switch (nm) {
+        case PropName::Size:
+            _observers.onValueChanged<FGCanvasGroup, &FGCanvasGroup::canvasSizeChanged>(prop, this);
             return true;
-        }
-
-        if ((nm == "view") || nm.startsWith("status") || (nm == "name") || (nm == "mipmapping") || (nm == "placement")) {
+        case PropName::View:
+        case PropName::Name:
+        case PropName::Mipmapping:
+        case PropName::Placement:
             return true;
+        default:
+            if (prop->name().startsWith("status")) {
+                return true;
+            }
+            break;
         }
     }
 
@@ -175,8 +191,12 @@ bool FGCanvasGroup::onChildRemoved(LocalProp *prop)
         return true;
     }
 
-    const QByteArray nm = prop->name();
-    if ((nm == "group") || (nm == "image") || (nm == "path") || (nm == "text") || (nm == "map")) {
+    switch (prop->nameAtom()) {
+    case PropName::Group:
+    case PropName::Image:
+    case PropName::Path:
+    case PropName::Text:
+    case PropName::Map: {
         int removedChildIndex = indexOfChildWithProp(prop);
         if (removedChildIndex >= 0) {
             auto it = _children.begin() + removedChildIndex;
@@ -186,8 +206,9 @@ bool FGCanvasGroup::onChildRemoved(LocalProp *prop)
         }
         return true;
     }
-
-    return false;
+    default:
+        return false;
+    }
 }
 
 void FGCanvasGroup::removeChild(FGCanvasElement *child)
@@ -209,6 +230,34 @@ void FGCanvasGroup::dumpElement()
     qDebug() << "End-group at" << _propertyRoot->path();
 }
 
+void FGCanvasGroup::addMemoryUsage(MemoryUsage& usage) const
+{
+    FGCanvasElement::addMemoryUsage(usage);
+    for (FGCanvasElement* e : _children) {
+        e->addMemoryUsage(usage);
+    }
+}
+
+QJsonObject FGCanvasGroup::memoryUsageReport() const
+{
+    QJsonObject json = FGCanvasElement::memoryUsageReport();
+
+    // leaf elements are only summed into their group, so the report stays
+    // proportional to the number of groups
+    QJsonArray groups;
+    for (FGCanvasElement* e : _children) {
+        if (qobject_cast<FGCanvasGroup*>(e)) {
+            groups.append(e->memoryUsageReport());
+        }
+    }
+
+    if (!groups.isEmpty()) {
+        json.insert("groups", groups);
+    }
+
+    return json;
+}
+
 int FGCanvasGroup::indexOfChildWithProp(LocalProp* prop) const
 {
     auto it = std::find_if(_children.begin(), _children.end(), [prop](FGCanvasElement* child)
@@ -28,6 +28,10 @@ public:
     void removeChild(FGCanvasElement* child);
 
     void dumpElement() override;
+
+    void addMemoryUsage(MemoryUsage& usage) const override;
+
+    QJsonObject memoryUsageReport() const override;
 signals:
     void childAdded();
     void childRemoved(int index);
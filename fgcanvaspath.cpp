@@ -28,6 +28,7 @@
 #include "fgcanvaspaintcontext.h"
 #include "localprop.h"
 #include "canvasitem.h"
+#include "memoryusage.h"
 
 #include "private/qtriangulator_p.h" // private QtGui header
 #include "private/qtriangulatingstroker_p.h" // private QtGui header
@@ -37,6 +38,21 @@
 #include <QSGGeometryNode>
 #include <QSGFlatColorMaterial>
 
+// resolved on every polish, so parsed once up-front
+static const PropPath RectPath("rect");
+static const PropPath TopPath("top");
+static const PropPath LeftPath("left");
+static const PropPath WidthPath("width");
+static const PropPath HeightPath("height");
+static const PropPath RightPath("right");
+static const PropPath BottomPath("bottom");
+static const PropPath BorderRadiusPath("border-radius");
+static const PropPath BorderRadius1Path("border-radius[1]");
+static const PropPath SvgPath("svg");
+static const PropPath StrokeLineCapPath("stroke-linecap");
+static const PropPath StrokeLineJoinPath("stroke-linejoin");
+static const PropPath StrokeDashArrayPath("stroke-dasharray");
+
 class PathQuickItem : public CanvasItem
 {
     Q_OBJECT
@@ -233,6 +249,12 @@ protected:
         return QQuickItem::boundingRect();
     }
 
+    void addMemoryUsage(MemoryUsage& usage) const override
+    {
+        CanvasItem::addMemoryUsage(usage);
+        usage.geometryBytes += MemoryUsage::pathBytes(m_path);
+    }
+
 private:
     QPainterPath m_path;
     QColor m_fillColor;
@@ -384,6 +406,8 @@ static void pathArc(QPainterPath &path,
 FGCanvasPath::FGCanvasPath(FGCanvasGroup* pr, LocalProp* prop) :
     FGCanvasElement(pr, prop)
 {
+    // cmd / coord values are packed on our node, rather than children
+    _observers.onPackedRunChanged<FGCanvasPath, &FGCanvasPath::markPathDirty>(prop, this);
 }
 
 void FGCanvasPath::dumpElement()
@@ -391,6 +415,12 @@ void FGCanvasPath::dumpElement()
     qDebug() << "Path: at " << _propertyRoot->path();
 }
 
+void FGCanvasPath::addMemoryUsage(MemoryUsage& usage) const
+{
+    FGCanvasElement::addMemoryUsage(usage);
+    usage.geometryBytes += MemoryUsage::pathBytes(_painterPath);
+}
+
 void FGCanvasPath::doPaint(FGCanvasPaintContext *context) const
 {
     context->painter()->setPen(_stroke);
@@ -490,36 +520,38 @@ bool FGCanvasPath::onChildAdded(LocalProp *prop)
         return true;
     }
 
-    if ((prop->name() == "cmd") || (prop->name() == "coord") || (prop->name() == "svg")) {
-        connect(prop, &LocalProp::valueChanged, this, &FGCanvasPath::markPathDirty);
+    switch (prop->nameAtom()) {
+    case PropName::Cmd:
+    case PropName::Coord:
+    case PropName::Svg:
+        _observers.onValueChanged<FGCanvasPath, &FGCanvasPath::markPathDirty>(prop, this);
         return true;
-    }
-
-    if (prop->name() == "rect") {
+    case PropName::Rect:
         _isRect = true;
-        connect(prop, &LocalProp::childAdded, this, &FGCanvasPath::onChildAdded);
+        _observers.onChildAdded<FGCanvasPath, &FGCanvasPath::onChildAdded>(prop, this);
         return true;
+    case PropName::CmdGeo:
+    case PropName::CoordGeo:
+        // ignore for now, we let the server-side transform down to cartesian.
+        // if we move that work to client side we could skip sending the cmd/coord data
+        return true;
+    default:
+        break;
     }
 
     // handle rect property changes
-    if (prop->parent()->name() == "rect") {
-        connect(prop, &LocalProp::valueChanged, this, &FGCanvasPath::markPathDirty);
+    if (prop->parent()->nameAtom() == PropName::Rect) {
+        _observers.onValueChanged<FGCanvasPath, &FGCanvasPath::markPathDirty>(prop, this);
         return true;
     }
 
     if (prop->name().startsWith("border-")) {
-        connect(prop, &LocalProp::valueChanged, this, &FGCanvasPath::markPathDirty);
-        return true;
-    }
-
-    if ((prop->name() == "cmd-geo") || (prop->name() == "coord-geo")) {
-        // ignore for now, we let the server-side transform down to cartesian.
-        // if we move that work to client side we could skip sending the cmd/coord data
+        _observers.onValueChanged<FGCanvasPath, &FGCanvasPath::markPathDirty>(prop, this);
         return true;
     }
 
     if (prop->name().startsWith("stroke")) {
-        connect(prop, &LocalProp::valueChanged, this, &FGCanvasPath::markStrokeDirty);
+        _observers.onValueChanged<FGCanvasPath, &FGCanvasPath::markStrokeDirty>(prop, this);
         return true;
     }
 
@@ -533,24 +565,25 @@ bool FGCanvasPath::onChildRemoved(LocalProp* prop)
         return true;
     }
 
-    const auto name = prop->name();
-    if (name == "rect") {
+    switch (prop->nameAtom()) {
+    case PropName::Rect:
         _isRect = false;
         markPathDirty();
         return true;
-    }
-
-    if ((name == "cmd") || (name == "coord") || (name == "svg")) {
+    case PropName::Cmd:
+    case PropName::Coord:
+    case PropName::Svg:
         markPathDirty();
         return true;
-    }
-
-    if ((name == "cmd-geo") || (name == "coord-geo")) {
+    case PropName::CmdGeo:
+    case PropName::CoordGeo:
         // ignored
         return true;
+    default:
+        break;
     }
 
-    if (name.startsWith("stroke")) {
+    if (prop->name().startsWith("stroke")) {
         markStrokeDirty();
         return true;
     }
@@ -598,21 +631,30 @@ void FGCanvasPath::rebuildPath() const
 
     if (_isRect) {
         rebuildFromRect(commands, coords);
-    } else if (_propertyRoot->hasChild("svg")) {
+    } else if (_propertyRoot->hasChild(PropName::Svg)) {
         if (!rebuildFromSVGData(commands, coords)) {
-            qWarning() << "failed to parse SVG path data" << _propertyRoot->value("svg", QVariant());
+            qWarning() << "failed to parse SVG path data" << _propertyRoot->value("svg", PropValue());
         }
     } else {
-        for (QVariant v : _propertyRoot->valuesOfChildren("coord")) {
+        // read the packed runs in place, unless they have holes to skip
+        const PackedRun* coordRun = _propertyRoot->packedRun(PropName::Coord);
+        const PackedRun* cmdRun = _propertyRoot->packedRun(PropName::Cmd);
+        if ((!coordRun || coordRun->isDense()) && (!cmdRun || cmdRun->isDense())) {
+            rebuildPathFromCommands(cmdRun ? cmdRun->intData() : nullptr, cmdRun ? cmdRun->size() : 0,
+                                    coordRun ? coordRun->floatData() : nullptr, coordRun ? coordRun->size() : 0);
+            return;
+        }
+
+        for (const PropValue& v : _propertyRoot->valuesOfChildren(PropName::Coord)) {
             coords.push_back(v.toFloat());
         }
 
-        for (QVariant v : _propertyRoot->valuesOfChildren("cmd")) {
+        for (const PropValue& v : _propertyRoot->valuesOfChildren(PropName::Cmd)) {
             commands.push_back(v.toInt());
         }
     }
 
-    rebuildPathFromCommands(commands, coords);
+    rebuildPathFromCommands(commands.data(), commands.size(), coords.data(), coords.size());
 }
 
 QByteArrayList splitSVGPathData(QByteArray d)
@@ -642,12 +684,12 @@ QByteArrayList splitSVGPathData(QByteArray d)
 bool hasComplexBorderRadius(const LocalProp* prop)
 {
     for (auto childProp : prop->children()) {
-        QByteArray name = childProp->name();
-        if (!name.startsWith("border-") || !name.endsWith("-radius")) {
+        if (childProp->nameAtom() == PropName::BorderRadius) {
             continue;
         }
 
-        if (name != "border-radius") {
+        const QByteArray& name = childProp->name();
+        if (name.startsWith("border-") && name.endsWith("-radius")) {
             return true;
         }
     } // of child prop iteration
@@ -657,33 +699,33 @@ bool hasComplexBorderRadius(const LocalProp* prop)
 
 bool FGCanvasPath::rebuildFromRect(std::vector<int>& commands, std::vector<float>& coords) const
 {
-    LocalProp* rectProp = _propertyRoot->getWithPath("rect");
+    LocalProp* rectProp = _propertyRoot->getWithPath(RectPath);
     if (hasComplexBorderRadius(_propertyRoot)) {
         // build a full path
         qWarning() << Q_FUNC_INFO << "implement me";
         _paintType = Path;
     } else {
-        float top = rectProp->value("top", 0.0).toFloat();
-        float left = rectProp->value("left", 0.0).toFloat();
-        float width = rectProp->value("width", 0.0).toFloat();
-        float height = rectProp->value("height", 0.0).toFloat();
+        float top = rectProp->value(TopPath, 0.0).toFloat();
+        float left = rectProp->value(LeftPath, 0.0).toFloat();
+        float width = rectProp->value(WidthPath, 0.0).toFloat();
+        float height = rectProp->value(HeightPath, 0.0).toFloat();
 
-        if (rectProp->hasChild("right")) {
-            width = rectProp->value("right", 0.0).toFloat() - left;
+        if (rectProp->hasChild(PropName::Right)) {
+            width = rectProp->value(RightPath, 0.0).toFloat() - left;
         }
 
-        if (rectProp->hasChild("bottom")) {
-            height = rectProp->value("bottom", 0.0).toFloat() - top;
+        if (rectProp->hasChild(PropName::Bottom)) {
+            height = rectProp->value(BottomPath, 0.0).toFloat() - top;
         }
 
         _rect = QRectF(left, top, width, height);
 
-        if (_propertyRoot->hasChild("border-radius")) {
+        if (_propertyRoot->hasChild(PropName::BorderRadius)) {
             // round-rect
-            float xR = _propertyRoot->value("border-radius", 0.0).toFloat();
+            float xR = _propertyRoot->value(BorderRadiusPath, 0.0).toFloat();
             float yR = xR;
-            if (_propertyRoot->hasChild("border-radius[1]")) {
-                yR = _propertyRoot->value("border-radius[1]", 0.0).toFloat();
+            if (_propertyRoot->hasChild(PropName::BorderRadius, 1)) {
+                yR = _propertyRoot->value(BorderRadius1Path, 0.0).toFloat();
             }
 
             _roundRectRadius = QSizeF(xR, yR);
@@ -699,7 +741,7 @@ bool FGCanvasPath::rebuildFromRect(std::vector<int>& commands, std::vector<float
 
 bool FGCanvasPath::rebuildFromSVGData(std::vector<int>& commands, std::vector<float>& coords) const
 {
-    QByteArrayList tokens = splitSVGPathData(_propertyRoot->value("svg", QVariant()).toByteArray());
+    QByteArrayList tokens = splitSVGPathData(_propertyRoot->value(SvgPath, PropValue()).toByteArray());
     PathCommands currentCommand = PathClose;
     bool isRelative = false;
     int numCoordsTokens = 0;
@@ -826,22 +868,24 @@ bool FGCanvasPath::rebuildFromSVGData(std::vector<int>& commands, std::vector<fl
     return true;
 }
 
-void FGCanvasPath::rebuildPathFromCommands(const std::vector<int>& commands, const std::vector<float>& coords) const
+void FGCanvasPath::rebuildPathFromCommands(const int* commands, size_t commandCount,
+                                           const float* coords, size_t coordCount) const
 {
     QPainterPath newPath;
-    const float* coord = coords.data();
+    const float* coord = coords;
     QPointF lastControlPoint; // for smooth cubics / quadric
     size_t currentCoord = 0;
 
-    for (int cmd : commands) {
+    for (const int* c = commands; c != commands + commandCount; ++c) {
+        const int cmd = *c;
         bool isRelative = cmd & 0x1;
         const int op = cmd & ~0x1;
         const int cmdIndex = op >> 1;
         const qreal baseX = isRelative ? newPath.currentPosition().x() : 0.0f;
         const qreal baseY = isRelative ? newPath.currentPosition().y() : 0.0f;
 
-        if ((currentCoord + CoordsPerCommand[cmdIndex]) > coords.size()) {
-            qWarning() << "insufficient path data" << currentCoord << cmdIndex << CoordsPerCommand[cmdIndex] << coords.size();
+        if ((currentCoord + CoordsPerCommand[cmdIndex]) > coordCount) {
+            qWarning() << "insufficient path data" << currentCoord << cmdIndex << CoordsPerCommand[cmdIndex] << coordCount;
             break;
         }
 
@@ -977,14 +1021,14 @@ void FGCanvasPath::rebuildPen() const
 {
     QPen p;
 
-    QVariant strokeColor = getCascadedStyle("stroke");
+    const PropValue strokeColor = getCascadedStyle(PropName::Stroke);
     p.setColor(parseColorValue(strokeColor));
 
-    p.setWidthF(getCascadedStyle("stroke-width", 1.0).toFloat());
-    p.setCapStyle(qtCapFromCanvas(_propertyRoot->value("stroke-linecap", QString()).toString()));
-    p.setJoinStyle(qtJoinFromCanvas(_propertyRoot->value("stroke-linejoin", QString()).toString()));
+    p.setWidthF(getCascadedStyle(PropName::StrokeWidth, 1.0).toFloat());
+    p.setCapStyle(qtCapFromCanvas(_propertyRoot->value(StrokeLineCapPath, QString()).toString()));
+    p.setJoinStyle(qtJoinFromCanvas(_propertyRoot->value(StrokeLineJoinPath, QString()).toString()));
 
-    QString dashArray = _propertyRoot->value("stroke-dasharray", QVariant()).toString();
+    QString dashArray = _propertyRoot->value(StrokeDashArrayPath, PropValue()).toString();
     if (!dashArray.isEmpty() && (dashArray != "none")) {
         p.setDashPattern(qtPenDashesFromCanvas(dashArray, p.widthF()));
     }
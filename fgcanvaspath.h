@@ -31,6 +31,8 @@ public:
     FGCanvasPath(FGCanvasGroup* pr, LocalProp* prop);
 
     void dumpElement() override;
+
+    void addMemoryUsage(MemoryUsage& usage) const override;
 protected:
     virtual void doPaint(FGCanvasPaintContext* context) const override;
 
@@ -53,7 +55,8 @@ private:
     void rebuildPath() const;
     void rebuildPen() const;
 
-    void rebuildPathFromCommands(const std::vector<int>& commands, const std::vector<float>& coords) const;
+    void rebuildPathFromCommands(const int* commands, size_t commandCount,
+                                 const float* coords, size_t coordCount) const;
     bool rebuildFromSVGData(std::vector<int>& commands, std::vector<float>& coords) const;
     bool rebuildFromRect(std::vector<int> &commands, std::vector<float> &coords) const;
 private:
@@ -267,33 +267,32 @@ bool FGCanvasText::onChildAdded(LocalProp *prop)
         return true;
     }
 
-    if (prop->name() == "text") {
-        connect(prop, &LocalProp::valueChanged, this, &FGCanvasText::onTextChanged);
+    switch (prop->nameAtom()) {
+    case PropName::Text:
+        _observers.onValueChanged<FGCanvasText, &FGCanvasText::onTextChanged>(prop, this);
         return true;
-    }
-
-    if (prop->name() == "draw-mode") {
-        connect(prop, &LocalProp::valueChanged, this, &FGCanvasText::setDrawMode);
+    case PropName::DrawMode:
+        _observers.onValueChanged<FGCanvasText, &FGCanvasText::setDrawMode>(prop, this);
         return true;
-    }
-
-    if (prop->name() == "character-aspect-ratio") {
+    case PropName::CharacterAspectRatio:
         return true;
+    default:
+        break;
     }
 
     qDebug() << "text saw child:" << prop->name() << prop->index();
     return false;
 }
 
-void FGCanvasText::onTextChanged(QVariant var)
+void FGCanvasText::onTextChanged(const PropValue& var)
 {
     _text = var.toString();
     if (_quickItem) {
-        _quickItem->setText(var.toString());
+        _quickItem->setText(_text);
     }
 }
 
-void FGCanvasText::setDrawMode(QVariant var)
+void FGCanvasText::setDrawMode(const PropValue& var)
 {
     int mode = var.toInt();
     if (mode != 1) {
@@ -301,7 +300,7 @@ void FGCanvasText::setDrawMode(QVariant var)
     }
 }
 
-void FGCanvasText::rebuildAlignment(QVariant var) const
+void FGCanvasText::rebuildAlignment(const PropValue& var) const
 {
     QByteArray alignString = var.toByteArray();
     if (alignString.isEmpty()) {
@@ -354,7 +353,7 @@ void FGCanvasText::markFontDirty()
 
 void FGCanvasText::onFontLoaded(QByteArray name)
 {
-    QByteArray fontName = getCascadedStyle("font", QString()).toByteArray();
+    QByteArray fontName = getCascadedStyle(PropName::Font, QString()).toByteArray();
     if (name != fontName) {
         return; // not our font
     }
@@ -366,7 +365,7 @@ void FGCanvasText::onFontLoaded(QByteArray name)
 
 void FGCanvasText::rebuildFont() const
 {
-    QByteArray fontName = getCascadedStyle("font", QString()).toByteArray();
+    QByteArray fontName = getCascadedStyle(PropName::Font, QString()).toByteArray();
     bool ok;
     auto fontCache = connection()->fontCache();
     QFont f = fontCache->fontForName(fontName, &ok);
@@ -376,11 +375,11 @@ void FGCanvasText::rebuildFont() const
         return;
     }
 
-    const int pixelSize = getCascadedStyle("character-size", 16).toInt();
+    const int pixelSize = getCascadedStyle(PropName::CharacterSize, 16).toInt();
     f.setPixelSize(pixelSize);
     _font = f;
     _metrics = QFontMetricsF(_font);
-    rebuildAlignment(getCascadedStyle("alignment"));
+    rebuildAlignment(getCascadedStyle(PropName::Alignment));
 
     if (_quickItem) {
         _quickItem->setFont(f);
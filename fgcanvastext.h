@@ -45,16 +45,16 @@ protected:
 private:
     bool onChildAdded(LocalProp *prop) override;
 
-    void onTextChanged(QVariant var);
+    void onTextChanged(const PropValue& var);
 
-    void setDrawMode(QVariant var);
+    void setDrawMode(const PropValue& var);
 
     void markFontDirty();
 
     void onFontLoaded(QByteArray name);
 private:
     void rebuildFont() const;
-    void rebuildAlignment(QVariant var) const;
+    void rebuildAlignment(const PropValue& var) const;
 
     QString _text;
 
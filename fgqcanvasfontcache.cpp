@@ -61,6 +61,28 @@ void FGQCanvasFontCache::setHost(QString hostName, int portNumber)
     m_port = portNumber;
 }
 
+void FGQCanvasFontCache::setBundle(SnapshotFile::Ptr bundle)
+{
+    m_bundle = bundle;
+}
+
+QByteArray FGQCanvasFontCache::fontData(QByteArray name) const
+{
+    if (m_bundle) {
+        const QByteArray data = m_bundle->fontData(name);
+        if (!data.isEmpty()) {
+            return QByteArray(data.constData(), data.size()); // detach from the mapping
+        }
+    }
+
+    QFile f(QStandardPaths::locate(QStandardPaths::CacheLocation, name));
+    if (f.fileName().isEmpty() || !f.open(QIODevice::ReadOnly)) {
+        return QByteArray();
+    }
+
+    return f.readAll();
+}
+
 void FGQCanvasFontCache::onFontDownloadFinished()
 {
     QByteArray fontPath = sender()->property("font").toByteArray();
@@ -95,20 +117,44 @@ void FGQCanvasFontCache::onFontDownloadError(QNetworkReply::NetworkError)
     qWarning() << "font download failed:" << reply->errorString();
 }
 
+bool FGQCanvasFontCache::addFont(QByteArray name, int fontFamilyId)
+{
+    if (fontFamilyId < 0) {
+        return false;
+    }
+
+    QStringList families = QFontDatabase::applicationFontFamilies(fontFamilyId);
+    qDebug() << "families are:" << families;
+    if (families.isEmpty()) {
+        return false;
+    }
+
+    // compute a QFont and cache
+    QFont font(families.front());
+    m_cache.insert(name, font);
+    return true;
+}
+
 void FGQCanvasFontCache::lookupFile(QByteArray name)
 {
+    if (m_bundle) {
+        const QByteArray bundled = m_bundle->fontData(name);
+        if (!bundled.isEmpty()) {
+            // QFontDatabase keeps the data for good, so it can't point into
+            // the mapping
+            const QByteArray data(bundled.constData(), bundled.size());
+            if (addFont(name, QFontDatabase::addApplicationFontFromData(data))) {
+                return;
+            }
+            qWarning() << "Failed to load bundled font into QFontDatabase:" << name;
+        }
+    }
+
     QString path = QStandardPaths::locate(QStandardPaths::CacheLocation, name);
     if (!path.isEmpty()) {
         qDebug() << "found font" << name << "at path" << path;
 
-        int fontFamilyId = QFontDatabase::addApplicationFont(path);
-        if (fontFamilyId >= 0) {
-            QStringList families = QFontDatabase::applicationFontFamilies(fontFamilyId);
-            qDebug() << "families are:" << families;
-
-            // compute a QFont and cache
-            QFont font(families.front());
-            m_cache.insert(name, font);
+        if (addFont(name, QFontDatabase::addApplicationFont(path))) {
             return;
         } else {
             qWarning() << "Failed to load font into QFontDatabase:" << path;
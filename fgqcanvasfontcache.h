@@ -24,6 +24,8 @@
 #include <QHash>
 #include <QNetworkReply>
 
+#include "snapshotfile.h"
+
 class QNetworkAccessManager;
 
 class FGQCanvasFontCache : public QObject
@@ -35,6 +37,18 @@ public:
     QFont fontForName(QByteArray name, bool* ok = nullptr);
 
     void setHost(QString hostName, int portNumber);
+
+    /**
+     * @brief use the fonts bundled in a snapshot before the disk cache or
+     * the network. The bundle is kept open while the cache uses it.
+     */
+    void setBundle(SnapshotFile::Ptr bundle);
+
+    /**
+     * @brief the contents of the font file for name, if it is bundled or
+     * in the disk cache; empty otherwise
+     */
+    QByteArray fontData(QByteArray name) const;
 signals:
     void fontLoaded(QByteArray name);
 
@@ -47,8 +61,10 @@ private:
     QHash<QByteArray, QFont> m_cache;
     QString m_hostName;
     int m_port;
+    SnapshotFile::Ptr m_bundle;
 
     void lookupFile(QByteArray name);
+    bool addFont(QByteArray name, int fontFamilyId);
 
     QList<QNetworkReply*> m_transfers;
 };
@@ -26,6 +26,7 @@
 #include "fgqcanvasimageloader.h"
 #include "canvasitem.h"
 #include "canvasconnection.h"
+#include "memoryusage.h"
 
 
 #include <QSGGeometry>
@@ -35,6 +36,16 @@
 #include <QSGSimpleTextureNode>
 #include <QQuickWindow>
 
+// resolved on every polish, so parsed once up-front
+static const PropPath SourceNormalizedPath("source/normalized");
+static const PropPath SourceLeftPath("source/left");
+static const PropPath SourceTopPath("source/top");
+static const PropPath SourceRightPath("source/right");
+static const PropPath SourceBottomPath("source/bottom");
+static const PropPath FilePath("file");
+static const PropPath Size0Path("size[0]");
+static const PropPath Size1Path("size[1]");
+
 class ImageQuickItem : public CanvasItem
 {
     Q_OBJECT
@@ -104,6 +115,13 @@ protected:
         return QQuickItem::boundingRect();
     }
 
+    // the texture belongs to the render thread, so isn't counted
+    void addMemoryUsage(MemoryUsage& usage) const override
+    {
+        CanvasItem::addMemoryUsage(usage);
+        usage.geometryBytes += MemoryUsage::pixmapBytes(m_pixmap);
+    }
+
 private:
     QRectF m_sourceRect;
     QSGTexture* m_texture = nullptr;
@@ -140,21 +158,24 @@ bool FGQCanvasImage::onChildAdded(LocalProp *prop)
         return true;
     }
 
-    const QByteArray nm = prop->name();
-    if ((nm == "src") || (nm == "size") || (nm == "file")) {
-        connect(prop, &LocalProp::valueChanged, this, &FGQCanvasImage::markImageDirty);
+    switch (prop->nameAtom()) {
+    case PropName::Src:
+    case PropName::Size:
+    case PropName::File:
+        _observers.onValueChanged<FGQCanvasImage, &FGQCanvasImage::markImageDirty>(prop, this);
         return true;
-    }
-
-    if (nm == "source") {
-        FGQCanvasImage* self = this;
-        connect(prop, &LocalProp::childAdded, [self](LocalProp* newChild) {
-            connect(newChild, &LocalProp::valueChanged, self, &FGQCanvasImage::markSourceDirty);
-        });
+    case PropName::Source:
+        _observers.onChildAdded<FGQCanvasImage, &FGQCanvasImage::onSourceChildAdded>(prop, this);
         return true;
+    default:
+        return false;
     }
+}
 
-    return false;
+bool FGQCanvasImage::onSourceChildAdded(LocalProp* prop)
+{
+    _observers.onValueChanged<FGQCanvasImage, &FGQCanvasImage::markSourceDirty>(prop, this);
+    return true;
 }
 
 void FGQCanvasImage::markImageDirty()
@@ -174,15 +195,15 @@ void FGQCanvasImage::recomputeSourceRect() const
     const float imageWidth = _image.width();
     const float imageHeight = _image.height();
     _sourceRect = QRectF(0, 0, imageWidth, imageHeight);
-    if (!_propertyRoot->hasChild("source")) {
+    if (!_propertyRoot->hasChild(PropName::Source)) {
         return;
     }
 
-    const bool normalized = _propertyRoot->value("source/normalized", true).toBool();
-    float left =  _propertyRoot->value("source/left", 0.0).toFloat();
-    float top =  _propertyRoot->value("source/top", 0.0).toFloat();
-    float right =  _propertyRoot->value("source/right", 1.0).toFloat();
-    float bottom =  _propertyRoot->value("source/bottom", 1.0).toFloat();
+    const bool normalized = _propertyRoot->value(SourceNormalizedPath, true).toBool();
+    float left =  _propertyRoot->value(SourceLeftPath, 0.0).toFloat();
+    float top =  _propertyRoot->value(SourceTopPath, 0.0).toFloat();
+    float right =  _propertyRoot->value(SourceRightPath, 1.0).toFloat();
+    float bottom =  _propertyRoot->value(SourceBottomPath, 1.0).toFloat();
 
     if (normalized) {
         left *= imageWidth;
@@ -201,7 +222,7 @@ void FGQCanvasImage::recomputeSourceRect() const
 
 void FGQCanvasImage::rebuildImage() const
 {
-    QByteArray file = _propertyRoot->value("file", QByteArray()).toByteArray();
+    QByteArray file = _propertyRoot->value(FilePath, QByteArray()).toByteArray();
     auto loader = connection()->imageLoader();
     if (!file.isEmpty()) {
          _image = loader->getImage(file);
@@ -220,8 +241,8 @@ void FGQCanvasImage::rebuildImage() const
         qDebug() << "src" << _propertyRoot->value("src", QString());
     }
 
-    _destSize = QSizeF(_propertyRoot->value("size[0]", 0.0).toFloat(),
-                       _propertyRoot->value("size[1]", 0.0).toFloat());
+    _destSize = QSizeF(_propertyRoot->value(Size0Path, 0.0).toFloat(),
+                       _propertyRoot->value(Size1Path, 0.0).toFloat());
 
     _imageDirty = false;
 
@@ -261,4 +282,10 @@ void FGQCanvasImage::dumpElement()
     qDebug() << "Image: " << _source << " at " << _propertyRoot->path();
 }
 
+void FGQCanvasImage::addMemoryUsage(MemoryUsage& usage) const
+{
+    FGCanvasElement::addMemoryUsage(usage);
+    usage.geometryBytes += MemoryUsage::pixmapBytes(_image);
+}
+
 #include "fgqcanvasimage.moc"
@@ -35,6 +35,8 @@ public:
     CanvasItem* quickItem() const override;
 
     void dumpElement() override;
+
+    void addMemoryUsage(MemoryUsage& usage) const override;
 protected:
     virtual void doPaint(FGCanvasPaintContext* context) const override;
 
@@ -49,6 +51,7 @@ private slots:
 
 private:
     bool onChildAdded(LocalProp *prop) override;
+    bool onSourceChildAdded(LocalProp* prop);
 
     void rebuildImage() const;
     void recomputeSourceRect() const;
@@ -23,6 +23,7 @@
 #include <QDir>
 #include <QFile>
 #include <QFileInfo>
+#include <QImage>
 
 class TransferSignalHolder : public QObject
 {
@@ -87,13 +88,28 @@ void FGQCanvasImageLoader::setHost(QString hostName, int portNumber)
     m_port = portNumber;
 }
 
-QPixmap FGQCanvasImageLoader::getImage(const QByteArray &imagePath)
+void FGQCanvasImageLoader::setBundle(SnapshotFile::Ptr bundle)
+{
+    m_bundle = bundle;
+}
+
+QPixmap FGQCanvasImageLoader::cachedImage(const QByteArray &imagePath)
 {
     if (m_cache.contains(imagePath)) {
         // cached, easy
         return m_cache.value(imagePath);
     }
 
+    if (m_bundle) {
+        // already decoded, no PNG to read
+        QImage image = m_bundle->image(imagePath);
+        if (!image.isNull()) {
+            QPixmap pix = QPixmap::fromImage(image);
+            m_cache.insert(imagePath, pix);
+            return pix;
+        }
+    }
+
     QString diskCachePath = QStandardPaths::locate(QStandardPaths::CacheLocation, imagePath);
     if (!diskCachePath.isEmpty()) {
         QPixmap pix;
@@ -103,6 +119,16 @@ QPixmap FGQCanvasImageLoader::getImage(const QByteArray &imagePath)
         return pix;
     }
 
+    return QPixmap();
+}
+
+QPixmap FGQCanvasImageLoader::getImage(const QByteArray &imagePath)
+{
+    QPixmap cached = cachedImage(imagePath);
+    if (!cached.isNull() || m_cache.contains(imagePath)) {
+        return cached; // including images which failed to load from disk
+    }
+
     QUrl url;
     url.setScheme("http");
     url.setHost(m_hostName);
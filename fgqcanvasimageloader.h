@@ -23,6 +23,8 @@
 #include <QMap>
 #include <QNetworkReply>
 
+#include "snapshotfile.h"
+
 class QNetworkAccessManager;
 
 class FGQCanvasImageLoader : public QObject
@@ -34,8 +36,20 @@ public:
 
     void setHost(QString hostName, int portNumber);
 
+    /**
+     * @brief use the images bundled in a snapshot before the disk cache or
+     * the network. The bundle is kept open while the loader uses it.
+     */
+    void setBundle(SnapshotFile::Ptr bundle);
+
     QPixmap getImage(const QByteArray& imagePath);
 
+    /**
+     * @brief the image if it is loaded, bundled or in the disk cache, but
+     * without requesting it from the host otherwise
+     */
+    QPixmap cachedImage(const QByteArray& imagePath);
+
     /**
      * @brief connectToImageLoaded - allow images to discover when they are loaded
      * @param imagePath - FGFS host relative path as found in the canvas (will be resolved
@@ -58,6 +72,7 @@ private:
     int m_port;
 
     QMap<QByteArray, QPixmap> m_cache;
+    SnapshotFile::Ptr m_bundle;
     QList<QNetworkReply*> m_transfers;
 
 };
@@ -36,11 +36,16 @@ void FGQCanvasMap::doPaint(FGCanvasPaintContext *context) const
 
 bool FGQCanvasMap::onChildAdded(LocalProp *prop)
 {
-    const QByteArray nm = prop->name();
-    if ((nm == "ref-lon") || (nm == "ref-lat") || (nm == "hdg") || (nm == "range")
-        || (nm == "screen-range")) {
-        connect(prop, &LocalProp::valueChanged, this, &FGQCanvasMap::markProjectionDirty);
+    switch (prop->nameAtom()) {
+    case PropName::RefLon:
+    case PropName::RefLat:
+    case PropName::Hdg:
+    case PropName::Range:
+    case PropName::ScreenRange:
+        _observers.onValueChanged<FGQCanvasMap, &FGQCanvasMap::markProjectionDirty>(prop, this);
         return true;
+    default:
+        break;
     }
 
     if (FGCanvasGroup::onChildAdded(prop)) {
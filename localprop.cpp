@@ -16,39 +16,210 @@
 // Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
 
 #include "localprop.h"
+#include "memoryusage.h"
+#include "snapshotfile.h"
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
 
-#include <QJsonValue>
 #include <QDebug>
+#include <QSet>
 
+// atoms are per-process, so streams carry the name itself
 QDataStream& operator<<(QDataStream& stream, const NameIndexTuple& nameIndex)
 {
-    stream << nameIndex.name << nameIndex.index;
+    stream << nameString(nameIndex.name) << nameIndex.index;
     return stream;
 }
 
 QDataStream& operator>>(QDataStream& stream, NameIndexTuple& nameIndex)
 {
-    stream >> nameIndex.name >> nameIndex.index;
+    QByteArray name;
+    stream >> name >> nameIndex.index;
+    nameIndex.name = internName(name);
     return stream;
 }
 
-LocalProp *LocalProp::getOrCreateWithPath(const QByteArray &path, QVariant defaultValue)
+bool PropPathIterator::next()
 {
-    if (path.isEmpty()) {
-        return this;
+    if (_final) {
+        return false;
     }
 
-    QList<QByteArray> segments = path.split('/');
-    LocalProp* result = this;
-    while (segments.size() > 1) {
-        QByteArray nameIndex = segments.front();
-        result = result->getOrCreateChildWithNameAndIndex(nameIndex);
-        segments.pop_front();
+    const char* segmentEnd = static_cast<const char*>(memchr(_pos, '/', _end - _pos));
+    if (!segmentEnd) {
+        segmentEnd = _end;
+    }
+
+    _name = _pos;
+    _nameSize = static_cast<int>(segmentEnd - _pos);
+    _index = 0;
+    if ((_nameSize > 0) && (_name[_nameSize - 1] == ']')) {
+        const char* leftBracket = static_cast<const char*>(memchr(_name, '[', _nameSize));
+        if (leftBracket) {
+            for (const char* c = leftBracket + 1; (*c >= '0') && (*c <= '9'); ++c) {
+                _index = (_index * 10) + (*c - '0');
+            }
+            _nameSize = static_cast<int>(leftBracket - _name);
+        }
+    }
+
+    _final = (segmentEnd == _end);
+    _pos = _final ? _end : segmentEnd + 1;
+    return true;
+}
+
+bool PropPathIterator::find(NameIndexTuple& ni) const
+{
+    ni.name = findName(_name, _nameSize);
+    ni.index = _index;
+    return ni.name != NoNameAtom;
+}
+
+NameIndexTuple PropPathIterator::intern() const
+{
+    return NameIndexTuple(internName(_name, _nameSize), _index);
+}
+
+PropPath::PropPath(const char* path)
+{
+    PropPathIterator it(path, static_cast<int>(strlen(path)));
+    while (it.next()) {
+        _segments.push_back(it.intern());
+    }
+}
+
+// marks the indices of a PackedRun which hold no value
+static const int PackedHole = std::numeric_limits<int>::min();
+
+PackedRun::PackedRun(NameAtom name, Type type, PropertyArena* arena) :
+    _name(name),
+    _type(type),
+    _floats(PropertyArenaAllocator<float>(arena)),
+    _ints(PropertyArenaAllocator<int>(arena)),
+    _mirrorIds(PropertyArenaAllocator<int>(arena))
+{
+}
+
+bool PackedRun::hasIndex(unsigned int index) const
+{
+    return (index < _mirrorIds.size()) && (_mirrorIds[index] != PackedHole);
+}
+
+PropValue PackedRun::value(unsigned int index) const
+{
+    if (!hasIndex(index)) {
+        return {};
     }
 
-    // for the final segment, pass the default value
-    if (!segments.empty()) {
-        result = result->getOrCreateChildWithNameAndIndex(segments.front(), defaultValue);
+    if (_type == Type::Float) {
+        return PropValue(static_cast<double>(_floats[index]));
+    }
+
+    return PropValue(_ints[index]);
+}
+
+int PackedRun::mirrorId(unsigned int index) const
+{
+    return hasIndex(index) ? _mirrorIds[index] : -1;
+}
+
+void PackedRun::setMirrorId(unsigned int index, int id)
+{
+    if (hasIndex(index)) {
+        _mirrorIds[index] = id;
+    }
+}
+
+bool PackedRun::set(unsigned int index, const PropValue& value)
+{
+    bool added = false;
+    if (index >= _mirrorIds.size()) {
+        // normally values arrive in index order, so this appends one
+        _holeCount += index - static_cast<unsigned int>(_mirrorIds.size());
+        _mirrorIds.resize(index + 1, PackedHole);
+        if (_type == Type::Float) {
+            _floats.resize(index + 1, 0.0f);
+        } else {
+            _ints.resize(index + 1, 0);
+        }
+        added = true;
+    } else if (_mirrorIds[index] == PackedHole) {
+        --_holeCount;
+        added = true;
+    }
+
+    if (added) {
+        _mirrorIds[index] = -1;
+    }
+
+    // converted as FGCanvasPath always did when reading the values back
+    if (_type == Type::Float) {
+        const float f = value.toFloat();
+        if (!added && (_floats[index] == f)) {
+            return false;
+        }
+        _floats[index] = f;
+    } else {
+        const int i = value.toInt();
+        if (!added && (_ints[index] == i)) {
+            return false;
+        }
+        _ints[index] = i;
+    }
+
+    return true;
+}
+
+bool PackedRun::remove(unsigned int index)
+{
+    if (!hasIndex(index)) {
+        return false;
+    }
+
+    _mirrorIds[index] = PackedHole;
+    ++_holeCount;
+    if (_type == Type::Float) {
+        _floats[index] = 0.0f;
+    } else {
+        _ints[index] = 0;
+    }
+
+    // drop trailing holes, so a path shortened from its end stays dense
+    size_t newSize = _mirrorIds.size();
+    while ((newSize > 0) && (_mirrorIds[newSize - 1] == PackedHole)) {
+        --newSize;
+        --_holeCount;
+    }
+
+    _mirrorIds.resize(newSize);
+    if (_type == Type::Float) {
+        _floats.resize(newSize);
+    } else {
+        _ints.resize(newSize);
+    }
+
+    return true;
+}
+
+LocalProp *LocalProp::getOrCreateWithPath(const QByteArray &path, PropValue defaultValue)
+{
+    return getOrCreateWithPath(path.constData(), path.size(), defaultValue);
+}
+
+LocalProp *LocalProp::getOrCreateWithPath(const char* path, int size, PropValue defaultValue)
+{
+    if (size == 0) {
+        return this;
+    }
+
+    PropPathIterator it(path, size);
+    LocalProp* result = this;
+    while (result && it.next()) {
+        // for the final segment, pass the default value
+        result = it.atLast() ? result->getOrCreateChildWithNameAndIndex(it.intern(), defaultValue)
+                             : result->getOrCreateChildWithNameAndIndex(it.intern());
     }
 
     return result;
@@ -56,16 +227,38 @@ LocalProp *LocalProp::getOrCreateWithPath(const QByteArray &path, QVariant defau
 
 LocalProp *LocalProp::getWithPath(const QByteArray &path) const
 {
-    if (path.isEmpty()) {
+    return getWithPath(path.constData(), path.size());
+}
+
+LocalProp *LocalProp::getWithPath(const char* path, int size) const
+{
+    if (size == 0) {
         return const_cast<LocalProp*>(this);
     }
 
-    QList<QByteArray> segments = path.split('/');
+    PropPathIterator it(path, size);
     LocalProp* result = const_cast<LocalProp*>(this);
-    while (!segments.empty()) {
-        QByteArray nameIndex = segments.front();
+    NameIndexTuple nameIndex;
+    while (it.next()) {
+        // a name which was never interned can't exist in any tree
+        if (!it.find(nameIndex)) {
+            return nullptr;
+        }
+
         result = result->childWithNameAndIndex(nameIndex);
-        segments.pop_front();
+        if (!result) {
+            return nullptr;
+        }
+    }
+
+    return result;
+}
+
+LocalProp *LocalProp::getWithPath(const PropPath& path) const
+{
+    LocalProp* result = const_cast<LocalProp*>(this);
+    for (const auto& ni : path.segments()) {
+        result = result->childWithNameAndIndex(ni);
         if (!result) {
             return nullptr;
         }
@@ -80,11 +273,116 @@ static bool lessThanPropNameIndex(const LocalProp* prop, const NameIndexTuple& n
 }
 
 
-LocalProp::LocalProp(LocalProp *pr, const NameIndexTuple& ni) :
-    QObject(pr),
+PropObserverSet::~PropObserverSet()
+{
+    clear();
+}
+
+// observers are only registered on the GUI thread
+static quint64 nextObserverSerial = 0;
+
+quint64 PropObserverSet::nextSerial()
+{
+    return nextObserverSerial;
+}
+
+void PropObserverSet::add(LocalProp* prop, PropEvent event, void* context, PropCallback callback,
+                          bool perProp)
+{
+    auto link = new PropObserverLink;
+    link->serial = nextObserverSerial++;
+    link->prop = prop;
+    link->owner = this;
+    link->context = context;
+    link->callback = callback;
+    link->event = event;
+    link->perProp = perProp;
+
+    link->ownerNext = _head;
+    if (_head) {
+        _head->ownerPrev = link;
+    }
+    _head = link;
+
+    prop->linkObserver(link);
+}
+
+void PropObserverSet::clear()
+{
+    while (_head) {
+        PropObserverLink* link = _head;
+        _head = link->ownerNext;
+        link->prop->unlinkObserver(link);
+        delete link;
+    }
+}
+
+void PropObserverSet::unlinkOwned(PropObserverLink* link)
+{
+    if (link->ownerPrev) {
+        link->ownerPrev->ownerNext = link->ownerNext;
+    } else {
+        _head = link->ownerNext;
+    }
+
+    if (link->ownerNext) {
+        link->ownerNext->ownerPrev = link->ownerPrev;
+    }
+}
+
+// each node is preceded by the arena it came from, or null for the heap,
+// so delete finds its way back; padded to keep the node aligned
+static const size_t NodeHeaderBytes = 16;
+
+void* LocalProp::operator new(size_t size)
+{
+    return operator new(size, nullptr);
+}
+
+void* LocalProp::operator new(size_t size, PropertyArena* arena)
+{
+    char* mem = static_cast<char*>(arena ? arena->allocate(NodeHeaderBytes + size)
+                                         : ::operator new(NodeHeaderBytes + size));
+    *reinterpret_cast<PropertyArena**>(mem) = arena;
+    if (arena) {
+        ++arena->_liveNodes;
+    }
+    return mem + NodeHeaderBytes;
+}
+
+void LocalProp::operator delete(void* p)
+{
+    if (!p) {
+        return;
+    }
+
+    char* mem = static_cast<char*>(p) - NodeHeaderBytes;
+    PropertyArena* arena = *reinterpret_cast<PropertyArena**>(mem);
+    if (arena) {
+        --arena->_liveNodes;
+        arena->deallocate(mem, NodeHeaderBytes + sizeof(LocalProp));
+    } else {
+        ::operator delete(mem);
+    }
+}
+
+void LocalProp::operator delete(void* p, PropertyArena*)
+{
+    operator delete(p);
+}
+
+LocalProp::LocalProp(LocalProp *pr, const NameIndexTuple& ni, PropertyArena* arena) :
+    _arena(pr ? pr->_arena : arena),
     _id(ni),
-    _parent(pr)
+    _parent(pr),
+    _children(PropertyArenaAllocator<LocalProp*>(_arena)),
+    _notify(pr ? pr->_notify : true)
+{
+}
+
+LocalProp* LocalProp::createRoot(PropertyArena* arena)
 {
+    return new (arena) LocalProp(nullptr, NameIndexTuple(""), arena);
 }
 
 LocalProp::~LocalProp()
@@ -92,14 +390,144 @@ LocalProp::~LocalProp()
     for (auto c : _children) {
         delete c;
     }
+
+    // delivered regardless of _notify: observers rely on it to forget us
+    notify(PropEvent::Destroyed);
+    detachObservers();
+
+    if (_finalizeSlot >= 0) {
+        _arena->removeFinalizable(this);
+    }
+
+    PropertyArenaAllocator<PackedRun> runAllocator(_arena);
+    while (_packedRuns) {
+        PackedRun* next = _packedRuns->_next;
+        _packedRuns->~PackedRun();
+        runAllocator.deallocate(_packedRuns, 1);
+        _packedRuns = next;
+    }
+}
+
+void LocalProp::releaseResources()
+{
+    _value.clear();
+    notify(PropEvent::Destroyed);
+    detachObservers();
+}
+
+void LocalProp::detachObservers()
+{
+    while (_observers) {
+        PropObserverLink* link = _observers;
+        unlinkObserver(link);
+        link->owner->unlinkOwned(link);
+        delete link;
+    }
+}
+
+void LocalProp::setValue(const PropValue& value)
+{
+    _value = value;
+    updateFinalizable();
+    markVersionDirty();
+}
+
+void LocalProp::markVersionDirty()
+{
+    // stops at the first dirty ancestor, so repeated changes are cheap
+    for (LocalProp* p = this; p && !p->_versionDirty; p = p->parent()) {
+        p->_versionDirty = true;
+    }
+}
+
+void LocalProp::updateFinalizable()
+{
+    // a node being released stays off the list while its observers detach
+    if (!_arena || (_arena->_releasing == this)) {
+        return;
+    }
+
+    const bool needed = _value.isString() || _observers;
+    if (needed && (_finalizeSlot < 0)) {
+        _arena->addFinalizable(this);
+    } else if (!needed && (_finalizeSlot >= 0)) {
+        _arena->removeFinalizable(this);
+    }
+}
+
+void LocalProp::notify(PropEvent event, LocalProp* child, quint64 sinceSerial)
+{
+    if (PropTransaction::isActive() &&
+        ((event == PropEvent::ValueChanged) || (event == PropEvent::PackedRunChanged)))
+    {
+        for (PropObserverLink* link = _observers; link; link = link->propNext) {
+            if ((link->event == event) && (link->serial >= sinceSerial)) {
+                PropTransaction::record(link);
+            }
+        }
+        return;
+    }
+
+    NotifyCursor cursor = { _observers, _notifying };
+    _notifying = &cursor;
+
+    while (cursor.next) {
+        PropObserverLink* link = cursor.next;
+        cursor.next = link->propNext;
+        if ((link->event == event) && (link->serial >= sinceSerial)) {
+            // may remove any observer, including this one
+            link->callback(link->context, this, child);
+        }
+    }
+
+    _notifying = cursor.outer;
+}
+
+void LocalProp::linkObserver(PropObserverLink* link)
+{
+    // at the head, so a notification in progress doesn't reach it
+    link->propNext = _observers;
+    if (_observers) {
+        _observers->propPrev = link;
+    }
+    _observers = link;
+    updateFinalizable();
+}
+
+void LocalProp::unlinkObserver(PropObserverLink* link)
+{
+    if (link->pendingSlot >= 0) {
+        PropTransaction::forget(link);
+    }
+
+    for (NotifyCursor* c = _notifying; c; c = c->outer) {
+        if (c->next == link) {
+            c->next = link->propNext;
+        }
+    }
+
+    if (link->propPrev) {
+        link->propPrev->propNext = link->propNext;
+    } else {
+        _observers = link->propNext;
+    }
+
+    if (link->propNext) {
+        link->propNext->propPrev = link->propPrev;
+    }
+
+    if (!_observers) {
+        updateFinalizable();
+    }
 }
 
-void LocalProp::processChange(QJsonValue json)
+void LocalProp::processChange(const PropValue& newValue)
 {
-    QVariant newValue = json.toVariant();
     if (newValue != _value) {
-        _value = newValue;
-        emit valueChanged(_value);
+        setValue(newValue);
+        if (_notify) {
+            notify(PropEvent::ValueChanged);
+        }
     }
 }
 
@@ -108,13 +536,54 @@ const NameIndexTuple &LocalProp::id() const
     return _id;
 }
 
+// the number of characters of '[index]', or zero for index 0
+static int indexSuffixLength(unsigned int index)
+{
+    if (index == 0) {
+        return 0;
+    }
+
+    int digits = 1;
+    for (; index >= 10; index /= 10) {
+        ++digits;
+    }
+    return digits + 2;
+}
+
 QByteArray LocalProp::path() const
 {
-    if (_parent) {
-        return _parent->path() + '/' + _id.toString();
+    // size the result first, then fill it from the end: one allocation,
+    // however deep the node is
+    int length = 0;
+    for (const LocalProp* p = this; p; p = p->_parent) {
+        length += nameString(p->_id.name).size() + indexSuffixLength(p->_id.index);
+        if (p->_parent) {
+            ++length; // separator
+        }
     }
 
-    return _id.toString();
+    QByteArray result(length, Qt::Uninitialized);
+    char* out = result.data() + length;
+    for (const LocalProp* p = this; p; p = p->_parent) {
+        unsigned int index = p->_id.index;
+        if (index > 0) {
+            *--out = ']';
+            for (; index > 0; index /= 10) {
+                *--out = static_cast<char>('0' + (index % 10));
+            }
+            *--out = '[';
+        }
+
+        const QByteArray& name = nameString(p->_id.name);
+        out -= name.size();
+        memcpy(out, name.constData(), static_cast<size_t>(name.size()));
+        if (p->_parent) {
+            *--out = '/';
+        }
+    }
+
+    Q_ASSERT(out == result.data());
+    return result;
 }
 
 LocalProp *LocalProp::childWithNameAndIndex(const NameIndexTuple& ni) const
@@ -129,80 +598,243 @@ LocalProp *LocalProp::childWithNameAndIndex(const NameIndexTuple& ni) const
 
 bool LocalProp::hasChild(const char* name) const
 {
-    return childWithNameAndIndex(QByteArray::fromRawData(name, strlen(name))) != nullptr;
+    PropPathIterator it(name, static_cast<int>(strlen(name)));
+    NameIndexTuple ni;
+    if (!it.next() || !it.find(ni)) {
+        return false;
+    }
+
+    return childWithNameAndIndex(ni) != nullptr;
 }
 
-void LocalProp::changeValue(const char *path, QVariant value)
+void LocalProp::changeValue(const char *path, PropValue value)
 {
     LocalProp* p = getOrCreateWithPath(path);
-    p->_value = value;
-    p->valueChanged(value);
+    if (!p) {
+        return;
+    }
+
+    p->setValue(value);
+    if (p->_notify) {
+        p->notify(PropEvent::ValueChanged);
+    }
 }
 
 void LocalProp::saveToStream(QDataStream &stream) const
 {
-    stream << _id << _position << _value;
-    stream << static_cast<int>(_children.size());
+    // values are streamed as QVariants, so the snapshot format is unchanged
+    stream << _id << _position << _value.toVariant();
+
+    // packed values are written as the leaf nodes they arrived as
+    int childCount = static_cast<int>(_children.size());
+    for (const PackedRun* run = _packedRuns; run; run = run->_next) {
+        for (unsigned int i = 0; i < run->size(); ++i) {
+            childCount += run->hasIndex(i) ? 1 : 0;
+        }
+    }
+
+    stream << childCount;
     for (auto child : _children) {
         child->saveToStream(stream);
     }
+
+    for (const PackedRun* run = _packedRuns; run; run = run->_next) {
+        for (unsigned int i = 0; i < run->size(); ++i) {
+            if (run->hasIndex(i)) {
+                stream << NameIndexTuple(run->name(), i) << 0u << run->value(i).toVariant() << 0;
+            }
+        }
+    }
 }
 
-LocalProp* LocalProp::restoreFromStream(QDataStream &stream, LocalProp* parent)
+// read past streamed nodes which can't be restored
+static void skipStreamedProps(QDataStream& stream, int count)
+{
+    for (int i = 0; (i < count) && (stream.status() == QDataStream::Ok); ++i) {
+        NameIndexTuple id;
+        unsigned int position;
+        QVariant value;
+        int childCount;
+        stream >> id >> position >> value >> childCount;
+        skipStreamedProps(stream, childCount);
+    }
+}
+
+LocalProp* LocalProp::restoreFromStream(QDataStream &stream, LocalProp* parent,
+                                        PropertyArena* arena)
 {
     NameIndexTuple id;
-    stream >> id;
-    LocalProp* prop = new LocalProp(parent, id);
-    stream >> prop->_position >> prop->_value;
+    unsigned int position;
+    QVariant value;
     int childCount;
-    stream >> childCount;
+    stream >> id >> position >> value >> childCount;
+    if (id.name == NoNameAtom) {
+        qWarning() << "can't restore" << (parent ? parent->path() : QByteArray())
+                   << "child: the property name table is full";
+        skipStreamedProps(stream, childCount);
+        return nullptr;
+    }
+
+    if (parent && (childCount == 0) && isPackedName(id.name)) {
+        parent->setPackedValue(id.name, id.index, PropValue::fromVariant(value));
+        return nullptr;
+    }
+
+    if (parent) {
+        arena = parent->_arena;
+    }
+
+    LocalProp* prop = new (arena) LocalProp(parent, id, arena);
+    prop->_position = position;
+    prop->setValue(PropValue::fromVariant(value));
     for (int c=0; c< childCount; ++c) {
-        prop->_children.push_back(restoreFromStream(stream, prop));
+        LocalProp* child = restoreFromStream(stream, prop);
+        if (child) {
+            prop->_children.push_back(child);
+        }
+    }
+
+    // the stream is ordered by the atoms of the process which wrote it
+    std::sort(prop->_children.begin(), prop->_children.end(),
+              [](const LocalProp* a, const LocalProp* b) { return a->id() < b->id(); });
+
+    return prop;
+}
+
+LocalProp* LocalProp::restoreFromSnapshot(const SnapshotFile& file, quint32 node,
+                                          LocalProp* parent, PropertyArena* arena)
+{
+    const SnapshotFormat::Node& record = file.node(node);
+    if (file.atom(record.name) == NoNameAtom) {
+        qWarning() << "can't restore" << (parent ? parent->path() : QByteArray())
+                   << "child: the property name table is full";
+        return nullptr;
+    }
+
+    if (parent) {
+        arena = parent->_arena;
+    }
+
+    LocalProp* prop = new (arena) LocalProp(parent, NameIndexTuple(file.atom(record.name), record.index), arena);
+    prop->_position = record.position;
+    prop->setValue(file.value(record));
+
+    for (quint32 r = 0; r < record.runCount; ++r) {
+        const SnapshotFormat::Run& runRecord = file.run(record.firstRun + r);
+        const NameAtom name = file.atom(runRecord.name);
+        const auto type = static_cast<PackedRun::Type>(runRecord.type);
+        PackedRun::Type expectedType;
+        const quint8* presence = file.presence(runRecord);
+        if (!isPackedName(name, &expectedType) || (expectedType != type)) {
+            // packed differently when written: fall back to a value at a time
+            for (quint32 i = 0; i < runRecord.size; ++i) {
+                if (!presence || presence[i]) {
+                    const PropValue v = (type == PackedRun::Type::Float) ?
+                                PropValue(static_cast<double>(file.floats(runRecord)[i])) :
+                                PropValue(file.ints(runRecord)[i]);
+                    if (isPackedName(name)) {
+                        prop->setPackedValue(name, i, v);
+                    } else {
+                        prop->getOrCreateChildWithNameAndIndex(NameIndexTuple(name, i), v);
+                    }
+                }
+            }
+            continue;
+        }
+
+        // copied as a block, rather than set value by value
+        PackedRun* run = prop->addPackedRun(name, type);
+        if (type == PackedRun::Type::Float) {
+            run->_floats.assign(file.floats(runRecord), file.floats(runRecord) + runRecord.size);
+        } else {
+            run->_ints.assign(file.ints(runRecord), file.ints(runRecord) + runRecord.size);
+        }
+
+        run->_mirrorIds.assign(runRecord.size, -1);
+        if (presence) {
+            for (quint32 i = 0; i < runRecord.size; ++i) {
+                if (!presence[i]) {
+                    run->_mirrorIds[i] = PackedHole;
+                    ++run->_holeCount;
+                }
+            }
+        }
+    }
+
+    prop->_children.reserve(prop->_children.size() + record.childCount);
+    for (quint32 c = 0; c < record.childCount; ++c) {
+        LocalProp* child = restoreFromSnapshot(file, record.firstChild + c, prop);
+        if (child) {
+            prop->_children.push_back(child);
+        }
     }
 
+    // the file is ordered by the atoms of the process which wrote it
+    std::sort(prop->_children.begin(), prop->_children.end(),
+              [](const LocalProp* a, const LocalProp* b) { return a->id() < b->id(); });
+
     return prop;
 }
 
-void LocalProp::recursiveNotifyRestored()
+void LocalProp::setNotificationsEnabled(bool enabled)
+{
+    _notify = enabled;
+    for (auto child : _children) {
+        child->setNotificationsEnabled(enabled);
+    }
+}
+
+void LocalProp::recursiveNotifyRestored(quint64 sinceSerial)
 {
-    emit valueChanged(_value);
+    notify(PropEvent::ValueChanged, nullptr, sinceSerial);
     for (auto child : _children) {
-        emit childAdded(child);
+        notify(PropEvent::ChildAdded, child, sinceSerial);
+    }
+
+    if (_packedRuns) {
+        notify(PropEvent::PackedRunChanged, nullptr, sinceSerial);
     }
 
     for (auto cc : _children) {
-        cc->recursiveNotifyRestored();
+        cc->recursiveNotifyRestored(sinceSerial);
     }
 }
 
 LocalProp *LocalProp::getOrCreateChildWithNameAndIndex(const NameIndexTuple& ni,
-                                                       QVariant defaultValue)
+                                                       PropValue defaultValue)
 {
     auto it = std::lower_bound(_children.begin(), _children.end(), ni, lessThanPropNameIndex);
     if ((it != _children.end()) && ((*it)->id() == ni)) {
         return *it;
     }
 
-    LocalProp* newChild = new LocalProp(this, ni);
-    newChild->_value = defaultValue;
+    if (ni.name == NoNameAtom) {
+        return nullptr; // the name table is full
+    }
+
+    LocalProp* newChild = new (_arena) LocalProp(this, ni);
+    newChild->setValue(defaultValue);
     _children.insert(it, newChild);
-    emit childAdded(newChild);
+    markVersionDirty();
+    if (_notify) {
+        notify(PropEvent::ChildAdded, newChild);
+    }
     return newChild;
 }
 
 LocalProp *LocalProp::getOrCreateWithPath(const char *name)
 {
-    return getOrCreateWithPath(QByteArray::fromRawData(name, strlen(name)));
+    return getOrCreateWithPath(name, static_cast<int>(strlen(name)));
 }
 
 LocalProp *LocalProp::getWithPath(const char *name) const
 {
-    return getWithPath(QByteArray::fromRawData(name, strlen(name)));
+    return getWithPath(name, static_cast<int>(strlen(name)));
 }
 
-QByteArray LocalProp::name() const
+const QByteArray& LocalProp::name() const
 {
-    return _id.name;
+    return nameString(_id.name);
 }
 
 unsigned int LocalProp::index() const
@@ -212,7 +844,10 @@ unsigned int LocalProp::index() const
 
 void LocalProp::setPosition(unsigned int pos)
 {
-    _position = pos;
+    if (pos != _position) {
+        _position = pos;
+        markVersionDirty();
+    }
 }
 
 LocalProp *LocalProp::parent() const
@@ -220,11 +855,31 @@ LocalProp *LocalProp::parent() const
     return const_cast<LocalProp*>(_parent);
 }
 
-std::vector<QVariant> LocalProp::valuesOfChildren(const char *name) const
+std::vector<PropValue> LocalProp::valuesOfChildren(const char *name) const
 {
-    std::vector<QVariant> result;
+    const NameAtom atom = findName(name, static_cast<int>(strlen(name)));
+    if (atom == NoNameAtom) {
+        return {};
+    }
+
+    return valuesOfChildren(atom);
+}
 
-    for (LocalProp* c : childrenWithName(name)) {
+std::vector<PropValue> LocalProp::valuesOfChildren(NameAtom name) const
+{
+    std::vector<PropValue> result;
+    if (const PackedRun* run = packedRun(name)) {
+        for (unsigned int i = 0; i < run->size(); ++i) {
+            if (run->hasIndex(i)) {
+                result.push_back(run->value(i));
+            }
+        }
+        return result;
+    }
+
+    const LocalPropSpan span = childrenNamed(name);
+    result.reserve(span.size());
+    for (LocalProp* c : span) {
         result.push_back(c->value());
     }
 
@@ -233,20 +888,51 @@ std::vector<QVariant> LocalProp::valuesOfChildren(const char *name) const
 
 std::vector<LocalProp *> LocalProp::childrenWithName(const char *name) const
 {
-    std::vector<LocalProp *> result;
-    for (LocalProp* child : _children) {
-        if (child->_id.name == name)
-            result.push_back(child);
+    const NameAtom atom = findName(name, static_cast<int>(strlen(name)));
+    if (atom == NoNameAtom) {
+        return {};
     }
-    return result;
+
+    return childrenWithName(atom);
+}
+
+std::vector<LocalProp *> LocalProp::childrenWithName(NameAtom name) const
+{
+    const LocalPropSpan span = childrenNamed(name);
+    return std::vector<LocalProp *>(span.begin(), span.end());
 }
 
-QVariant LocalProp::value() const
+// children sort by name then index, so those sharing a name are adjacent
+struct ChildNameLess
 {
-    return _value;
+    bool operator()(const LocalProp* prop, NameAtom name) const
+    {
+        return prop->nameAtom() < name;
+    }
+
+    bool operator()(NameAtom name, const LocalProp* prop) const
+    {
+        return name < prop->nameAtom();
+    }
+};
+
+LocalPropSpan LocalProp::childrenNamed(NameAtom name) const
+{
+    const auto range = std::equal_range(_children.begin(), _children.end(), name, ChildNameLess());
+    return LocalPropSpan(range.first, range.second);
+}
+
+PropValue LocalProp::value(const char *path, PropValue defaultValue) const
+{
+    LocalProp* n = getWithPath(path);
+    if (!n || n->value().isNull()) {
+        return defaultValue;
+    }
+
+    return n->value();
 }
 
-QVariant LocalProp::value(const char *path, QVariant defaultValue) const
+PropValue LocalProp::value(const PropPath& path, PropValue defaultValue) const
 {
     LocalProp* n = getWithPath(path);
     if (!n || n->value().isNull()) {
@@ -256,12 +942,224 @@ QVariant LocalProp::value(const char *path, QVariant defaultValue) const
     return n->value();
 }
 
+void LocalProp::addMemoryUsage(MemoryUsage& usage) const
+{
+    usage.propertyCount++;
+    usage.propertyBytes += sizeof(LocalProp) + (_children.capacity() * sizeof(LocalProp*));
+    if (_value.isString()) {
+        usage.valueBytes += MemoryUsage::stringBytes(_value.toString());
+    }
+
+    for (const PropObserverLink* link = _observers; link; link = link->propNext) {
+        usage.observerCount++;
+    }
+
+    for (const PackedRun* run = _packedRuns; run; run = run->_next) {
+        usage.packedValueCount += run->size() - run->_holeCount;
+        usage.propertyBytes += sizeof(PackedRun) +
+                (run->_floats.capacity() * sizeof(float)) +
+                ((run->_ints.capacity() + run->_mirrorIds.capacity()) * sizeof(int));
+    }
+
+    for (const LocalProp* child : _children) {
+        child->addMemoryUsage(usage);
+    }
+}
+
+bool LocalProp::isPackedName(NameAtom name, PackedRun::Type* type)
+{
+    // path geometry: the only long runs of numeric siblings in a Canvas.
+    // coord-geo / cmd-geo aren't numeric, so stay as nodes.
+    switch (name) {
+    case PropName::Coord:
+        if (type) {
+            *type = PackedRun::Type::Float;
+        }
+        return true;
+    case PropName::Cmd:
+        if (type) {
+            *type = PackedRun::Type::Int;
+        }
+        return true;
+    default:
+        return false;
+    }
+}
+
+const PackedRun* LocalProp::packedRun(NameAtom name) const
+{
+    for (const PackedRun* run = _packedRuns; run; run = run->_next) {
+        if (run->name() == name) {
+            return run;
+        }
+    }
+
+    return nullptr;
+}
+
+PackedRun* LocalProp::packedRun(NameAtom name)
+{
+    return const_cast<PackedRun*>(static_cast<const LocalProp*>(this)->packedRun(name));
+}
+
+void LocalProp::setPackedValue(NameAtom name, unsigned int index, const PropValue& value)
+{
+    PackedRun* run = packedRun(name);
+    if (!run) {
+        PackedRun::Type type;
+        if (!isPackedName(name, &type)) {
+            qWarning() << "not a packed property name:" << nameString(name);
+            return;
+        }
+
+        run = addPackedRun(name, type);
+    }
+
+    if (run->set(index, value)) {
+        markVersionDirty();
+        if (_notify) {
+            notify(PropEvent::PackedRunChanged);
+        }
+    }
+}
+
+PackedRun* LocalProp::addPackedRun(NameAtom name, PackedRun::Type type)
+{
+    PropertyArenaAllocator<PackedRun> runAllocator(_arena);
+    PackedRun* run = new (runAllocator.allocate(1)) PackedRun(name, type, _arena);
+    run->_next = _packedRuns;
+    _packedRuns = run;
+    return run;
+}
+
+void LocalProp::removePackedValue(NameAtom name, unsigned int index)
+{
+    PackedRun* run = packedRun(name);
+    if (run && run->remove(index)) {
+        markVersionDirty();
+        if (_notify) {
+            notify(PropEvent::PackedRunChanged);
+        }
+    }
+}
+
 void LocalProp::removeChild(LocalProp *prop)
 {
     Q_ASSERT(prop->parent() == this);
     auto it = std::find(_children.begin(), _children.end(), prop);
     Q_ASSERT(it != _children.end());
     _children.erase(it);
-    emit childRemoved(prop);
+    markVersionDirty();
+    if (_notify) {
+        notify(PropEvent::ChildRemoved, prop);
+    }
     delete prop;
 }
+
+namespace {
+
+// a call deferred by PropTransaction, compared to drop duplicates
+struct DeferredCall
+{
+    void* context;
+    PropCallback callback;
+    LocalProp* prop; ///< null unless the call is per property
+
+    bool operator==(const DeferredCall& other) const
+    {
+        return (context == other.context) && (callback == other.callback) && (prop == other.prop);
+    }
+};
+
+uint qHash(const DeferredCall& call, uint seed)
+{
+    return ::qHash(call.context, seed) ^ ::qHash(reinterpret_cast<quintptr>(call.callback), seed)
+        ^ ::qHash(call.prop, seed);
+}
+
+struct TransactionState
+{
+    int depth = 0;
+    bool delivering = false;
+    std::vector<PropObserverLink*> pending; ///< null where forgotten
+    QSet<DeferredCall> delivered;
+};
+
+TransactionState& transactionState()
+{
+    static TransactionState state;
+    return state;
+}
+
+} // of anonymous namespace
+
+void PropTransaction::begin()
+{
+    ++transactionState().depth;
+}
+
+int PropTransaction::end()
+{
+    TransactionState& state = transactionState();
+    Q_ASSERT(state.depth > 0);
+    if ((--state.depth > 0) || state.delivering) {
+        return 0;
+    }
+
+    // changes made by the calls are delivered immediately; a transaction
+    // opened by one of them adds to the list being walked here
+    state.delivering = true;
+    int calls = 0;
+    size_t passEnd = state.pending.size();
+    for (size_t i = 0; i < state.pending.size(); ++i) {
+        // calls are only merged within a pass: those recorded while
+        // delivering are later changes, which observers must see again
+        if (i == passEnd) {
+            state.delivered.clear();
+            passEnd = state.pending.size();
+        }
+
+        PropObserverLink* link = state.pending[i];
+        if (!link) {
+            continue;
+        }
+
+        link->pendingSlot = -1;
+        const DeferredCall call = { link->context, link->callback, link->perProp ? link->prop : nullptr };
+        if (state.delivered.contains(call)) {
+            continue;
+        }
+
+        state.delivered.insert(call);
+        // may remove any observer, including this one
+        link->callback(link->context, link->prop, nullptr);
+        ++calls;
+    }
+
+    state.pending.clear();
+    state.delivered.clear();
+    state.delivering = false;
+    return calls;
+}
+
+bool PropTransaction::isActive()
+{
+    return transactionState().depth > 0;
+}
+
+void PropTransaction::record(PropObserverLink* link)
+{
+    if (link->pendingSlot >= 0) {
+        return; // already waiting
+    }
+
+    TransactionState& state = transactionState();
+    link->pendingSlot = static_cast<int>(state.pending.size());
+    state.pending.push_back(link);
+}
+
+void PropTransaction::forget(PropObserverLink* link)
+{
+    transactionState().pending[link->pendingSlot] = nullptr;
+    link->pendingSlot = -1;
+}
@@ -19,38 +19,51 @@
 #define LOCALPROP_H
 
 #include <QByteArray>
-#include <QVariant>
 #include <QVector>
-#include <QObject>
 #include <QDataStream>
 
+#include "nameatom.h"
+#include "propertyarena.h"
+#include "propvalue.h"
+
+/**
+ * @brief The name and index of a property, eg 'coord[3]'. The name is
+ * interned, so comparisons are integer comparisons.
+ */
 struct NameIndexTuple
 {
-    QByteArray name;
+    NameAtom name = PropName::Empty;
     unsigned int index = 0;
 
     NameIndexTuple()
     {}
 
-    NameIndexTuple(const char* nm, unsigned int idx) :
+    NameIndexTuple(NameAtom nm, unsigned int idx) :
         name(nm),
         index(idx)
     {}
 
-    NameIndexTuple(const QByteArray& bytes) :
-        name(bytes)
+    NameIndexTuple(const char* nm, unsigned int idx) :
+        name(internName(nm, static_cast<int>(strlen(nm)))),
+        index(idx)
+    {}
+
+    /// parse a path segment such as 'coord[3]', interning the name
+    NameIndexTuple(const QByteArray& bytes)
     {
         Q_ASSERT(bytes.indexOf('/') == -1);
         if (bytes.endsWith(']')) {
             int leftBracket = bytes.indexOf('[');
             index = bytes.mid(leftBracket + 1, bytes.length() - (leftBracket + 2)).toInt();
-            name = bytes.left(leftBracket);
+            name = internName(bytes.left(leftBracket));
+        } else {
+            name = internName(bytes);
         }
     }
 
     QByteArray toString() const
     {
-        QByteArray p = name;
+        QByteArray p = nameString(name);
         if (index > 0) {
             p += '[' + QByteArray::number(index) + ']';
         }
@@ -62,6 +75,7 @@ struct NameIndexTuple
         return (name == other.name) && (index == other.index);
     }
 
+    /// orders by atom, then index: not alphabetical, see NameAtom
     bool operator<(const NameIndexTuple& other) const
     {
         if (name == other.name) {
@@ -76,25 +90,340 @@ struct NameIndexTuple
 QDataStream& operator<<(QDataStream& stream, const NameIndexTuple& nameIndex);
 QDataStream& operator>>(QDataStream& stream, NameIndexTuple& nameIndex);
 
-class LocalProp : public QObject
+/**
+ * @brief Walks the segments of a relative path such as 'source/left' or
+ * 'coord[3]' in place, without copying or allocating.
+ */
+class PropPathIterator
+{
+public:
+    /// path must stay valid while iterating
+    PropPathIterator(const char* path, int size) :
+        _pos(path),
+        _end(path + size)
+    {}
+
+    /// move to the next segment; false once there are none left
+    bool next();
+
+    /// true if the current segment is the final one
+    bool atLast() const
+    {
+        return _pos == _end;
+    }
+
+    /// the current segment, for lookups: false if its name was never
+    /// interned, in which case no property can have it
+    bool find(NameIndexTuple& ni) const;
+
+    /// the current segment, interning its name
+    NameIndexTuple intern() const;
+
+private:
+    const char* _pos;
+    const char* _end;
+    const char* _name = nullptr;
+    int _nameSize = 0;
+    unsigned int _index = 0;
+    bool _final = false;
+};
+
+/**
+ * @brief A relative path, parsed and interned once. Use it for paths
+ * which are resolved repeatedly, eg by element code on every polish.
+ */
+class PropPath
+{
+public:
+    explicit PropPath(const char* path);
+
+    const std::vector<NameIndexTuple>& segments() const
+    {
+        return _segments;
+    }
+
+private:
+    std::vector<NameIndexTuple> _segments;
+};
+
+class LocalProp;
+class PropObserverSet;
+class SnapshotFile;
+struct MemoryUsage;
+
+enum class PropEvent : quint8
+{
+    ValueChanged,
+    ChildAdded,
+    ChildRemoved,
+    Destroyed,
+    PackedRunChanged ///< a value of a PackedRun was set or removed
+};
+
+/// child is the added or removed child, or null for the other events
+using PropCallback = void (*)(void* context, LocalProp* prop, LocalProp* child);
+
+/**
+ * @brief One observer registration. It is linked into the list of the
+ * observed property and into the list of the PropObserverSet owning it,
+ * so that either side can be destroyed first.
+ */
+struct PropObserverLink
+{
+    LocalProp* prop;
+    PropObserverSet* owner;
+    void* context;
+    PropCallback callback;
+    PropEvent event;
+    bool perProp; ///< deferred calls are made per property, see PropTransaction
+    int pendingSlot = -1; ///< in the current PropTransaction, if deferred
+    quint64 serial; ///< order of registration, see PropObserverSet::nextSerial()
+
+    PropObserverLink* propPrev = nullptr;
+    PropObserverLink* propNext = nullptr;
+    PropObserverLink* ownerPrev = nullptr;
+    PropObserverLink* ownerNext = nullptr;
+};
+
+/**
+ * @brief The property observations made by one object, typically an
+ * element. The methods are typed wrappers binding a member function, and
+ * everything is unregistered when the set is cleared or destroyed.
+ *
+ * Observers added while a property is notifying aren't called for that
+ * notification; observers removed meanwhile are no longer called.
+ */
+class PropObserverSet
+{
+public:
+    PropObserverSet() = default;
+    ~PropObserverSet();
+
+    PropObserverSet(const PropObserverSet&) = delete;
+    PropObserverSet& operator=(const PropObserverSet&) = delete;
+
+    /// perProp: the callback depends on which property notified
+    void add(LocalProp* prop, PropEvent event, void* context, PropCallback callback,
+             bool perProp = true);
+
+    template <class T, void (T::*Method)()>
+    void onValueChanged(LocalProp* prop, T* object);
+
+    template <class T, void (T::*Method)(const PropValue&)>
+    void onValueChanged(LocalProp* prop, T* object);
+
+    template <class T, void (T::*Method)(LocalProp*)>
+    void onValueChanged(LocalProp* prop, T* object);
+
+    template <class T, bool (T::*Method)(LocalProp*)>
+    void onChildAdded(LocalProp* prop, T* object);
+
+    template <class T, bool (T::*Method)(LocalProp*)>
+    void onChildRemoved(LocalProp* prop, T* object);
+
+    template <class T, void (T::*Method)()>
+    void onDestroyed(LocalProp* prop, T* object);
+
+    template <class T, void (T::*Method)()>
+    void onPackedRunChanged(LocalProp* prop, T* object);
+
+    void clear();
+
+    /// the serial of the next observer registered, by any set
+    static quint64 nextSerial();
+
+private:
+    friend class LocalProp;
+
+    template <class T, void (T::*Method)()>
+    static void callNoArgs(void* context, LocalProp*, LocalProp*);
+
+    template <class T, void (T::*Method)(const PropValue&)>
+    static void callWithValue(void* context, LocalProp* prop, LocalProp*);
+
+    template <class T, void (T::*Method)(LocalProp*)>
+    static void callWithProp(void* context, LocalProp* prop, LocalProp*);
+
+    template <class T, bool (T::*Method)(LocalProp*)>
+    static void callWithChild(void* context, LocalProp*, LocalProp* child);
+
+    /// unlink from our list only, the property side is handled by the caller
+    void unlinkOwned(PropObserverLink* link);
+
+    PropObserverLink* _head = nullptr;
+};
+
+using LocalPropVec = std::vector<LocalProp*, PropertyArenaAllocator<LocalProp*>>;
+
+/**
+ * @brief The values of a run of numeric siblings such as coord[0] ..
+ * coord[n], held in one contiguous array on their parent instead of as a
+ * LocalProp each. Path geometry arrives as thousands of these, and is
+ * read back as a whole whenever it changes.
+ *
+ * Indices which were never set, or have been removed, are holes: they
+ * read as zero in the data arrays, and isDense() is false while any exist.
+ */
+class PackedRun
+{
+public:
+    enum class Type : quint8
+    {
+        Float,
+        Int
+    };
+
+    PackedRun(NameAtom name, Type type, PropertyArena* arena);
+
+    NameAtom name() const
+    {
+        return _name;
+    }
+
+    Type type() const
+    {
+        return _type;
+    }
+
+    /// one past the highest index present
+    unsigned int size() const
+    {
+        return static_cast<unsigned int>(_mirrorIds.size());
+    }
+
+    bool isDense() const
+    {
+        return _holeCount == 0;
+    }
+
+    bool hasIndex(unsigned int index) const;
+
+    /// the values of a Float run, size() of them
+    const float* floatData() const
+    {
+        return _floats.data();
+    }
+
+    /// the values of an Int run, size() of them
+    const int* intData() const
+    {
+        return _ints.data();
+    }
+
+    PropValue value(unsigned int index) const;
+
+    /// PropertyTreeMirror id of the value at index, as LocalProp::mirrorId
+    int mirrorId(unsigned int index) const;
+
+    void setMirrorId(unsigned int index, int id);
+
+    /// the next run of the same parent
+    PackedRun* next() const
+    {
+        return _next;
+    }
+
+private:
+    friend class LocalProp;
+
+    /// returns true if the value was added or changed
+    bool set(unsigned int index, const PropValue& value);
+
+    /// returns false if there was no value at index
+    bool remove(unsigned int index);
+
+    const NameAtom _name;
+    const Type _type;
+    unsigned int _holeCount = 0;
+    PackedRun* _next = nullptr;
+    std::vector<float, PropertyArenaAllocator<float>> _floats;
+    std::vector<int, PropertyArenaAllocator<int>> _ints;
+    std::vector<int, PropertyArenaAllocator<int>> _mirrorIds;
+};
+
+/**
+ * @brief The children of a LocalProp which share a name, in index order.
+ * A view of the parent's sorted children, valid until they change.
+ */
+class LocalPropSpan
+{
+public:
+    using const_iterator = LocalPropVec::const_iterator;
+
+    LocalPropSpan(const_iterator first, const_iterator last) :
+        _begin(first),
+        _end(last)
+    {}
+
+    const_iterator begin() const
+    {
+        return _begin;
+    }
+
+    const_iterator end() const
+    {
+        return _end;
+    }
+
+    size_t size() const
+    {
+        return static_cast<size_t>(_end - _begin);
+    }
+
+    bool empty() const
+    {
+        return _begin == _end;
+    }
+
+    LocalProp* operator[](size_t i) const
+    {
+        return *(_begin + i);
+    }
+
+private:
+    const_iterator _begin;
+    const_iterator _end;
+};
+
+/**
+ * @brief A mirrored property. Deliberately not a QObject: there can be
+ * hundreds of thousands per canvas, so observers are kept in a compact
+ * intrusive list (see PropObserverSet) instead of signal connections.
+ */
+class LocalProp
 {
-    Q_OBJECT
 public:
-    LocalProp(LocalProp* parent, const NameIndexTuple& ni);
+    /// children are allocated like their parent; arena is used for roots
+    LocalProp(LocalProp* parent, const NameIndexTuple& ni, PropertyArena* arena = nullptr);
+
+    ~LocalProp();
+
+    /// a root node, allocated from arena, or the heap if it is null
+    static LocalProp* createRoot(PropertyArena* arena);
+
+    static void* operator new(size_t size);
+    static void* operator new(size_t size, PropertyArena* arena);
+    static void operator delete(void* p);
+    static void operator delete(void* p, PropertyArena* arena);
 
-    virtual ~LocalProp();
+    LocalProp(const LocalProp&) = delete;
+    LocalProp& operator=(const LocalProp&) = delete;
 
-    void processChange(QJsonValue newValue);
+    void processChange(const PropValue& newValue);
 
     const NameIndexTuple& id() const;
 
     QByteArray path() const;
 
-    LocalProp* getOrCreateWithPath(const QByteArray& path, QVariant defaultValue = {});
+    /// the getOrCreate methods return null if a name can't be interned,
+    /// because the name table is full
+    LocalProp* getOrCreateWithPath(const QByteArray& path, PropValue defaultValue = {});
+
+    LocalProp* getOrCreateWithPath(const char* path, int size, PropValue defaultValue = {});
 
     LocalProp* childWithNameAndIndex(const NameIndexTuple& ni) const;
 
-    LocalProp* getOrCreateChildWithNameAndIndex(const NameIndexTuple& ni, QVariant defaultValue = {});
+    LocalProp* getOrCreateChildWithNameAndIndex(const NameIndexTuple& ni, PropValue defaultValue = {});
 
     LocalProp* getOrCreateWithPath(const char* name);
 
@@ -102,7 +431,16 @@ public:
 
     LocalProp* getWithPath(const char* name) const;
 
-    QByteArray name() const;
+    LocalProp* getWithPath(const char* path, int size) const;
+
+    LocalProp* getWithPath(const PropPath& path) const;
+
+    const QByteArray& name() const;
+
+    NameAtom nameAtom() const
+    {
+        return _id.name;
+    }
 
     unsigned int index() const;
 
@@ -116,42 +454,297 @@ public:
 
     void setPosition(unsigned int pos);
 
+    /// PropertyTreeMirror id, or -1 for nodes the server hasn't sent to us
+    /// directly (intermediate path segments, or restored from a snapshot)
+    int mirrorId() const
+    {
+        return _mirrorId;
+    }
+
+    void setMirrorId(int id)
+    {
+        _mirrorId = id;
+    }
+
     LocalProp* parent() const;
 
-    std::vector<LocalProp*> children() const
+    const LocalPropVec& children() const
     { return _children; }
 
-    std::vector<QVariant> valuesOfChildren(const char* name) const;
+    std::vector<PropValue> valuesOfChildren(const char* name) const;
+
+    std::vector<PropValue> valuesOfChildren(NameAtom name) const;
 
     std::vector<LocalProp*> childrenWithName(const char* name) const;
 
-    QVariant value() const;
+    std::vector<LocalProp*> childrenWithName(NameAtom name) const;
 
-    QVariant value(const char* path, QVariant defaultValue) const;
+    /// the children called name, found by binary search and not copied
+    LocalPropSpan childrenNamed(NameAtom name) const;
+
+    size_t childCount(NameAtom name) const
+    {
+        return childrenNamed(name).size();
+    }
+
+    const PropValue& value() const
+    {
+        return _value;
+    }
+
+    PropValue value(const char* path, PropValue defaultValue) const;
+
+    PropValue value(const PropPath& path, PropValue defaultValue) const;
 
     void removeChild(LocalProp* prop);
 
     bool hasChild(const char* name) const;
 
-    void changeValue(const char* path, QVariant value);
+    bool hasChild(NameAtom name, unsigned int index = 0) const
+    {
+        return childWithNameAndIndex(NameIndexTuple(name, index)) != nullptr;
+    }
+
+    void changeValue(const char* path, PropValue value);
+
+    /**
+     * @brief whether values called name are stored in a PackedRun on their
+     * parent, rather than as child nodes, and as which type
+     */
+    static bool isPackedName(NameAtom name, PackedRun::Type* type = nullptr);
+
+    /// the run of packed values called name, or null if there are none
+    const PackedRun* packedRun(NameAtom name) const;
+
+    PackedRun* packedRun(NameAtom name);
+
+    /// the first of this node's runs, continued by PackedRun::next()
+    PackedRun* packedRuns() const
+    {
+        return _packedRuns;
+    }
+
+    /**
+     * @brief set name[index] in a packed run, creating the run as needed.
+     * Observers are told by PackedRunChanged, not per value.
+     */
+    void setPackedValue(NameAtom name, unsigned int index, const PropValue& value);
+
+    void removePackedValue(NameAtom name, unsigned int index);
 
     void saveToStream(QDataStream& stream) const;
 
-    static LocalProp* restoreFromStream(QDataStream& stream, LocalProp *parent);
+    /// arena is used if parent is null, otherwise nodes go where parent is
+    static LocalProp* restoreFromStream(QDataStream& stream, LocalProp *parent,
+                                        PropertyArena* arena = nullptr);
 
-    void recursiveNotifyRestored();
-signals:
-    void valueChanged(QVariant val);
+    /// build the subtree at node of a version 2 snapshot, reading straight
+    /// from its mapping; arena is used as for restoreFromStream
+    static LocalProp* restoreFromSnapshot(const SnapshotFile& file, quint32 node,
+                                          LocalProp* parent, PropertyArena* arena = nullptr);
 
-    void childAdded(LocalProp* child);
-    void childRemoved(LocalProp* child);
+    /**
+     * @brief enable or disable the value-changed / child-added / removed
+     * notifications of this node and its descendants. New children take the
+     * setting of their parent, so a tree can be built silently, eg for the
+     * initial sync of a connection.
+     */
+    void setNotificationsEnabled(bool enabled);
+
+    bool notificationsEnabled() const
+    {
+        return _notify;
+    }
+
+    /**
+     * @brief send, in a single pass, the notifications which building this
+     * tree incrementally would have produced, so elements can be created
+     * for a tree which was restored or built with notifications disabled.
+     * Only observers registered from sinceSerial on are notified (see
+     * PropObserverSet::nextSerial()), so that elements already displaying
+     * the tree don't see its nodes again.
+     */
+    void recursiveNotifyRestored(quint64 sinceSerial = 0);
+
+    /// add the memory held by this node and its descendants to usage
+    void addMemoryUsage(MemoryUsage& usage) const;
 
 private:
+    friend class PropObserverSet;
+    friend class PropertyArena;
+    friend class PropTreePublisher;
+
+    /// a notification in progress, so observers can be removed during it
+    struct NotifyCursor
+    {
+        PropObserverLink* next;
+        NotifyCursor* outer;
+    };
+
+    void notify(PropEvent event, LocalProp* child = nullptr, quint64 sinceSerial = 0);
+    void linkObserver(PropObserverLink* link);
+    void unlinkObserver(PropObserverLink* link);
+    void detachObservers();
+
+    void setValue(const PropValue& value);
+
+    PackedRun* addPackedRun(NameAtom name, PackedRun::Type type);
+
+    /// this node or something below it changed since the last published
+    /// version, see PropTreePublisher
+    void markVersionDirty();
+
+    /// track whether PropertyArena::release() must visit this node
+    void updateFinalizable();
+
+    /// what the destructor does for this node alone, for bulk release
+    void releaseResources();
+
+    PropertyArena* const _arena;
+
     const NameIndexTuple _id;
     const LocalProp* _parent;
-    std::vector<LocalProp*> _children;
-    QVariant _value;
+    LocalPropVec _children;
+    PropValue _value;
     unsigned int _position = 0;
+    int _mirrorId = -1;
+    bool _notify = true;
+    bool _versionDirty = true;
+    PropObserverLink* _observers = nullptr;
+    NotifyCursor* _notifying = nullptr;
+    int _finalizeSlot = -1; ///< index in the arena's finalizable list
+    PackedRun* _packedRuns = nullptr;
+};
+
+template <class T, void (T::*Method)()>
+void PropObserverSet::onValueChanged(LocalProp* prop, T* object)
+{
+    add(prop, PropEvent::ValueChanged, object, &callNoArgs<T, Method>, false);
+}
+
+template <class T, void (T::*Method)(const PropValue&)>
+void PropObserverSet::onValueChanged(LocalProp* prop, T* object)
+{
+    add(prop, PropEvent::ValueChanged, object, &callWithValue<T, Method>);
+}
+
+template <class T, void (T::*Method)(LocalProp*)>
+void PropObserverSet::onValueChanged(LocalProp* prop, T* object)
+{
+    add(prop, PropEvent::ValueChanged, object, &callWithProp<T, Method>);
+}
+
+template <class T, bool (T::*Method)(LocalProp*)>
+void PropObserverSet::onChildAdded(LocalProp* prop, T* object)
+{
+    add(prop, PropEvent::ChildAdded, object, &callWithChild<T, Method>);
+}
+
+template <class T, bool (T::*Method)(LocalProp*)>
+void PropObserverSet::onChildRemoved(LocalProp* prop, T* object)
+{
+    add(prop, PropEvent::ChildRemoved, object, &callWithChild<T, Method>);
+}
+
+template <class T, void (T::*Method)()>
+void PropObserverSet::onDestroyed(LocalProp* prop, T* object)
+{
+    add(prop, PropEvent::Destroyed, object, &callNoArgs<T, Method>);
+}
+
+template <class T, void (T::*Method)()>
+void PropObserverSet::onPackedRunChanged(LocalProp* prop, T* object)
+{
+    add(prop, PropEvent::PackedRunChanged, object, &callNoArgs<T, Method>, false);
+}
+
+template <class T, void (T::*Method)()>
+void PropObserverSet::callNoArgs(void* context, LocalProp*, LocalProp*)
+{
+    (static_cast<T*>(context)->*Method)();
+}
+
+template <class T, void (T::*Method)(const PropValue&)>
+void PropObserverSet::callWithValue(void* context, LocalProp* prop, LocalProp*)
+{
+    (static_cast<T*>(context)->*Method)(prop->value());
+}
+
+template <class T, void (T::*Method)(LocalProp*)>
+void PropObserverSet::callWithProp(void* context, LocalProp* prop, LocalProp*)
+{
+    (static_cast<T*>(context)->*Method)(prop);
+}
+
+template <class T, bool (T::*Method)(LocalProp*)>
+void PropObserverSet::callWithChild(void* context, LocalProp*, LocalProp* child)
+{
+    (static_cast<T*>(context)->*Method)(child);
+}
+
+/**
+ * @brief Defers value notifications while a frame of changes is applied,
+ * so that an observer bound to several properties - the six m[i] of a tf,
+ * the edges of a rect - is called once per frame instead of per change.
+ *
+ * Between begin() and end(), ValueChanged and PackedRunChanged are
+ * recorded rather than delivered. end() then makes each distinct call
+ * once: per object and method for methods taking no arguments, per
+ * property as well for those taking the property or its value. Child
+ * added / removed and destroyed notifications are always immediate.
+ *
+ * Transactions nest, and only the outermost end() delivers. Like the
+ * rest of the tree, for use on the GUI thread only.
+ */
+class PropTransaction
+{
+public:
+    static void begin();
+
+    /// returns the number of calls made
+    static int end();
+
+    static bool isActive();
+
+private:
+    friend class LocalProp;
+
+    static void record(PropObserverLink* link);
+    static void forget(PropObserverLink* link);
+};
+
+/**
+ * @brief A weak reference to a LocalProp, which becomes null when the
+ * property is destroyed; the equivalent of QPointer.
+ */
+class LocalPropRef
+{
+public:
+    LocalPropRef() = default;
+
+    LocalPropRef& operator=(LocalProp* prop)
+    {
+        _observers.clear();
+        _prop = prop;
+        if (prop) {
+            _observers.onDestroyed<LocalPropRef, &LocalPropRef::onDestroyed>(prop, this);
+        }
+        return *this;
+    }
+
+    LocalProp* get() const
+    {
+        return _prop;
+    }
+
+private:
+    void onDestroyed()
+    {
+        _prop = nullptr;
+    }
+
+    LocalProp* _prop = nullptr;
+    PropObserverSet _observers;
 };
 
 #endif // LOCALPROP_H
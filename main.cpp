@@ -40,6 +40,20 @@ int main(int argc, char *argv[])
     QCommandLineOption framelessOption(QStringList() << "frameless",
                                    QCoreApplication::translate("main", "Use a frameless window"));
     parser.addOption(framelessOption);
+    QCommandLineOption binaryFramesOption(QStringList() << "binary-frames",
+                                   QCoreApplication::translate("main", "Request binary change frames from the server"));
+    parser.addOption(binaryFramesOption);
+    QCommandLineOption recordOption(QStringList() << "record",
+                                   QCoreApplication::translate("main", "Record received frames into <directory>"),
+                                   "directory");
+    parser.addOption(recordOption);
+    QCommandLineOption journalOption(QStringList() << "journal",
+                                   QCoreApplication::translate("main", "Journal the state of each canvas into <directory>, by default the application data directory when given a configuration"),
+                                   "directory");
+    parser.addOption(journalOption);
+    QCommandLineOption recoverOption(QStringList() << "recover",
+                                   QCoreApplication::translate("main", "Restore the canvases journaled by a previous run"));
+    parser.addOption(recoverOption);
     parser.process(a);
 
     ApplicationController appController;
@@ -58,6 +72,18 @@ int main(int argc, char *argv[])
     }
     quickView.rootContext()->setContextProperty("_application", &appController);
 
+    if (parser.isSet(binaryFramesOption)) {
+        appController.setPreferBinaryFrames(true);
+    }
+
+    if (parser.isSet(recordOption)) {
+        appController.setRecordingDirectory(parser.value(recordOption));
+    }
+
+    if (parser.isSet(journalOption)) {
+        appController.setJournalDirectory(parser.value(journalOption));
+    }
+
     const QStringList args = parser.positionalArguments();
 
     if (!args.empty()) {
@@ -66,6 +92,10 @@ int main(int argc, char *argv[])
     } else {
         quickView.setWidth(1024);
         quickView.setHeight(768);
+
+        if (parser.isSet(recoverOption)) {
+            appController.restoreJournal();
+        }
     }
 
     quickView.setSource(QUrl("qrc:///qml/mainMenu.qml"));
@@ -0,0 +1,73 @@
+//
+// Copyright (C) 2026 The fgqcanvas contributors
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as
+// published by the Free Software Foundation; either version 2 of the
+// License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+
+#include "memoryusage.h"
+
+#include <QPainterPath>
+#include <QPixmap>
+#include <QString>
+
+MemoryUsage& MemoryUsage::operator+=(const MemoryUsage& other)
+{
+    propertyCount += other.propertyCount;
+    packedValueCount += other.packedValueCount;
+    propertyBytes += other.propertyBytes;
+    valueBytes += other.valueBytes;
+    observerCount += other.observerCount;
+    reservedBytes += other.reservedBytes;
+    elementCount += other.elementCount;
+    itemCount += other.itemCount;
+    signalConnectionCount += other.signalConnectionCount;
+    geometryBytes += other.geometryBytes;
+    return *this;
+}
+
+QJsonObject MemoryUsage::toJson() const
+{
+    // qint64 goes into JSON as a double, which is exact up to 2^53
+    QJsonObject json;
+    json.insert("propertyCount", static_cast<double>(propertyCount));
+    json.insert("packedValueCount", static_cast<double>(packedValueCount));
+    json.insert("propertyBytes", static_cast<double>(propertyBytes));
+    json.insert("valueBytes", static_cast<double>(valueBytes));
+    json.insert("observerCount", static_cast<double>(observerCount));
+    json.insert("reservedBytes", static_cast<double>(reservedBytes));
+    json.insert("elementCount", static_cast<double>(elementCount));
+    json.insert("itemCount", static_cast<double>(itemCount));
+    json.insert("signalConnectionCount", static_cast<double>(signalConnectionCount));
+    json.insert("geometryBytes", static_cast<double>(geometryBytes));
+    return json;
+}
+
+qint64 MemoryUsage::stringBytes(const QString& s)
+{
+    return static_cast<qint64>(s.capacity()) * static_cast<qint64>(sizeof(QChar));
+}
+
+qint64 MemoryUsage::pathBytes(const QPainterPath& path)
+{
+    return static_cast<qint64>(path.elementCount()) * static_cast<qint64>(sizeof(QPainterPath::Element));
+}
+
+qint64 MemoryUsage::pixmapBytes(const QPixmap& pixmap)
+{
+    if (pixmap.isNull()) {
+        return 0;
+    }
+
+    return static_cast<qint64>(pixmap.width()) * pixmap.height() * pixmap.depth() / 8;
+}
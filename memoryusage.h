@@ -0,0 +1,91 @@
+//
+// Copyright (C) 2026 The fgqcanvas contributors
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as
+// published by the Free Software Foundation; either version 2 of the
+// License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+
+#ifndef MEMORYUSAGE_H
+#define MEMORYUSAGE_H
+
+#include <QByteArray>
+#include <QJsonObject>
+#include <QMetaMethod>
+#include <QMetaObject>
+
+class QPainterPath;
+class QPixmap;
+class QString;
+
+/**
+ * @brief Memory held by a subtree of properties, elements and their quick
+ * items, for finding pathological canvases. Byte counts are estimates of
+ * what each object holds: allocator overhead is ignored, and implicitly
+ * shared data (strings, paths, pixmaps) is counted by every holder.
+ */
+struct MemoryUsage
+{
+    // property tree, see LocalProp::addMemoryUsage
+    qint64 propertyCount = 0;
+    qint64 packedValueCount = 0;
+    qint64 propertyBytes = 0;  ///< nodes, child arrays and packed runs
+    qint64 valueBytes = 0;     ///< string values, beyond the node itself
+    qint64 observerCount = 0;  ///< PropObserverSet registrations
+    qint64 reservedBytes = 0;  ///< held by the arena, including free blocks
+
+    // elements, see FGCanvasElement::addMemoryUsage
+    qint64 elementCount = 0;
+    qint64 itemCount = 0;
+    qint64 signalConnectionCount = 0;
+    qint64 geometryBytes = 0;  ///< cached paths and images
+
+    MemoryUsage& operator+=(const MemoryUsage& other);
+
+    QJsonObject toJson() const;
+
+    static qint64 stringBytes(const QString& s);
+    static qint64 pathBytes(const QPainterPath& path);
+    static qint64 pixmapBytes(const QPixmap& pixmap);
+
+    /**
+     * @brief connections to the signals of a QObject. Since
+     * QObject::receivers() is protected, the object passes a way to call it,
+     * eg [this](const char* s) { return receivers(s); }
+     */
+    template <class Receivers>
+    static qint64 signalConnections(const QMetaObject* mo, Receivers receivers);
+};
+
+template <class Receivers>
+qint64 MemoryUsage::signalConnections(const QMetaObject* mo, Receivers receivers)
+{
+    qint64 count = 0;
+    for (int i = 0; i < mo->methodCount(); ++i) {
+        const QMetaMethod method = mo->method(i);
+        // clones are the overloads generated for default arguments, and
+        // share their connections with the full signature
+        if ((method.methodType() != QMetaMethod::Signal) ||
+            (method.attributes() & QMetaMethod::Cloned))
+        {
+            continue;
+        }
+
+        // the encoding SIGNAL() gives, which receivers() expects
+        const QByteArray signature = QByteArray::number(QSIGNAL_CODE) + method.methodSignature();
+        count += receivers(signature.constData());
+    }
+
+    return count;
+}
+
+#endif // MEMORYUSAGE_H
@@ -0,0 +1,196 @@
+//
+// Copyright (C) 2026 The fgqcanvas contributors
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as
+// published by the Free Software Foundation; either version 2 of the
+// License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+
+#include "nameatom.h"
+
+#include <atomic>
+#include <cstring>
+#include <vector>
+
+#include <QDebug>
+#include <QHash>
+#include <QMutex>
+#include <QMutexLocker>
+
+namespace {
+
+// names live in fixed-size chunks which never move, so nameString can
+// read them without taking the lock
+const int ChunkBits = 10;
+const NameAtom ChunkSize = 1u << ChunkBits;
+const NameAtom MaxChunks = 4096;
+
+class NameTable
+{
+public:
+    NameTable()
+    {
+        for (auto& c : _chunks) {
+            c.store(nullptr, std::memory_order_relaxed);
+        }
+
+        _index.assign(256, NoNameAtom);
+
+        add("");
+#define FGQCANVAS_NAME_STRING(atom, str) add(str);
+        FGQCANVAS_WELL_KNOWN_NAMES(FGQCANVAS_NAME_STRING)
+#undef FGQCANVAS_NAME_STRING
+        Q_ASSERT(_count == PropName::WellKnownCount);
+    }
+
+    ~NameTable()
+    {
+        for (auto& c : _chunks) {
+            delete [] c.load(std::memory_order_relaxed);
+        }
+    }
+
+    NameAtom intern(const char* name, int size)
+    {
+        QMutexLocker g(&_lock);
+        const NameAtom existing = lookup(name, size);
+        if (existing != NoNameAtom) {
+            return existing;
+        }
+
+        return add(QByteArray(name, size));
+    }
+
+    NameAtom find(const char* name, int size)
+    {
+        QMutexLocker g(&_lock);
+        return lookup(name, size);
+    }
+
+    const QByteArray& string(NameAtom atom) const
+    {
+        Q_ASSERT(atom < ChunkSize * MaxChunks);
+        const QByteArray* chunk = _chunks[atom >> ChunkBits].load(std::memory_order_acquire);
+        Q_ASSERT(chunk);
+        return chunk[atom & (ChunkSize - 1)];
+    }
+
+private:
+    static uint hashOf(const char* name, int size)
+    {
+        return qHashBits(name, static_cast<size_t>(size));
+    }
+
+    // the index is open-addressed on the raw bytes, so that lookups from
+    // path segments needn't build a QByteArray key
+    NameAtom lookup(const char* name, int size) const
+    {
+        const uint mask = static_cast<uint>(_index.size()) - 1;
+        for (uint slot = hashOf(name, size) & mask; ; slot = (slot + 1) & mask) {
+            const NameAtom atom = _index[slot];
+            if (atom == NoNameAtom) {
+                return NoNameAtom;
+            }
+
+            const QByteArray& s = string(atom);
+            if ((s.size() == size) && (memcmp(s.constData(), name, static_cast<size_t>(size)) == 0)) {
+                return atom;
+            }
+        }
+    }
+
+    void insertIndex(NameAtom atom)
+    {
+        const QByteArray& s = string(atom);
+        const uint mask = static_cast<uint>(_index.size()) - 1;
+        uint slot = hashOf(s.constData(), s.size()) & mask;
+        while (_index[slot] != NoNameAtom) {
+            slot = (slot + 1) & mask;
+        }
+        _index[slot] = atom;
+    }
+
+    // called with the lock held, or from the constructor
+    NameAtom add(const QByteArray& name)
+    {
+        const NameAtom atom = _count;
+        const NameAtom chunkIndex = atom >> ChunkBits;
+        if (chunkIndex >= MaxChunks) {
+            // names come from peers and files: refuse them, rather than abort
+            if (!_fullWarned) {
+                qWarning() << "property name table is full," << atom << "names: ignoring new names";
+                _fullWarned = true;
+            }
+            return NoNameAtom;
+        }
+
+        QByteArray* chunk = _chunks[chunkIndex].load(std::memory_order_relaxed);
+        if (!chunk) {
+            chunk = new QByteArray[ChunkSize];
+        }
+
+        chunk[atom & (ChunkSize - 1)] = name;
+        _chunks[chunkIndex].store(chunk, std::memory_order_release);
+        ++_count;
+
+        // keep the load factor at most one half
+        if (_count * 2 > _index.size()) {
+            _index.assign(_index.size() * 2, NoNameAtom);
+            for (NameAtom a = 0; a < _count; ++a) {
+                insertIndex(a);
+            }
+        } else {
+            insertIndex(atom);
+        }
+
+        return atom;
+    }
+
+    QMutex _lock;
+    std::vector<NameAtom> _index;
+    std::atomic<QByteArray*> _chunks[MaxChunks];
+    NameAtom _count = 0;
+    bool _fullWarned = false;
+};
+
+NameTable& nameTable()
+{
+    static NameTable table;
+    return table;
+}
+
+} // of anonymous namespace
+
+NameAtom internName(const QByteArray& name)
+{
+    return nameTable().intern(name.constData(), name.size());
+}
+
+NameAtom internName(const char* name, int size)
+{
+    return nameTable().intern(name, size);
+}
+
+NameAtom findName(const QByteArray& name)
+{
+    return nameTable().find(name.constData(), name.size());
+}
+
+NameAtom findName(const char* name, int size)
+{
+    return nameTable().find(name, size);
+}
+
+const QByteArray& nameString(NameAtom atom)
+{
+    return nameTable().string(atom);
+}
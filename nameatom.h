@@ -0,0 +1,123 @@
+//
+// Copyright (C) 2026 The fgqcanvas contributors
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as
+// published by the Free Software Foundation; either version 2 of the
+// License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+
+#ifndef NAMEATOM_H
+#define NAMEATOM_H
+
+#include <QByteArray>
+
+/**
+ * @brief A property name, interned in a per-process table so that names
+ * compare as integers. Atoms are only meaningful within one process:
+ * anything persisted must store the name itself (see nameString).
+ *
+ * The ordering of atoms is the order names were interned in, not the
+ * alphabetical order of the names.
+ */
+using NameAtom = quint32;
+
+/// returned by findName for names which were never interned, and by
+/// internName once the table is full
+const NameAtom NoNameAtom = ~0u;
+
+// the Canvas property names the elements route on, interned up-front
+#define FGQCANVAS_WELL_KNOWN_NAMES(X) \
+    X(Group, "group") \
+    X(Path, "path") \
+    X(Text, "text") \
+    X(Image, "image") \
+    X(Map, "map") \
+    X(Tf, "tf") \
+    X(M, "m") \
+    X(MGeo, "m-geo") \
+    X(Visible, "visible") \
+    X(TfRotIndex, "tf-rot-index") \
+    X(Center, "center") \
+    X(Id, "id") \
+    X(Update, "update") \
+    X(Clip, "clip") \
+    X(ClipFrame, "clip-frame") \
+    X(SymbolType, "symbol-type") \
+    X(LayerType, "layer-type") \
+    X(ZIndex, "z-index") \
+    X(Font, "font") \
+    X(LineHeight, "line-height") \
+    X(Alignment, "alignment") \
+    X(CharacterSize, "character-size") \
+    X(CharacterAspectRatio, "character-aspect-ratio") \
+    X(DrawMode, "draw-mode") \
+    X(Fill, "fill") \
+    X(FillOpacity, "fill-opacity") \
+    X(Background, "background") \
+    X(Stroke, "stroke") \
+    X(StrokeWidth, "stroke-width") \
+    X(Cmd, "cmd") \
+    X(Coord, "coord") \
+    X(Svg, "svg") \
+    X(CmdGeo, "cmd-geo") \
+    X(CoordGeo, "coord-geo") \
+    X(Rect, "rect") \
+    X(Left, "left") \
+    X(Top, "top") \
+    X(Right, "right") \
+    X(Bottom, "bottom") \
+    X(Width, "width") \
+    X(Height, "height") \
+    X(BorderRadius, "border-radius") \
+    X(Src, "src") \
+    X(File, "file") \
+    X(Size, "size") \
+    X(Source, "source") \
+    X(Normalized, "normalized") \
+    X(RefLon, "ref-lon") \
+    X(RefLat, "ref-lat") \
+    X(Hdg, "hdg") \
+    X(Range, "range") \
+    X(ScreenRange, "screen-range") \
+    X(View, "view") \
+    X(Name, "name") \
+    X(Mipmapping, "mipmapping") \
+    X(Placement, "placement")
+
+namespace PropName
+{
+enum : NameAtom
+{
+    Empty = 0, ///< the name of root nodes
+#define FGQCANVAS_NAME_ATOM(atom, str) atom,
+    FGQCANVAS_WELL_KNOWN_NAMES(FGQCANVAS_NAME_ATOM)
+#undef FGQCANVAS_NAME_ATOM
+    WellKnownCount
+};
+}
+
+/// the atom for name, interning it if necessary; NoNameAtom if it isn't
+/// interned yet and the table is full. Thread-safe.
+NameAtom internName(const QByteArray& name);
+
+NameAtom internName(const char* name, int size);
+
+/// the atom for name if it was interned, otherwise NoNameAtom. Use this
+/// for lookups, so that querying doesn't grow the table. Doesn't allocate.
+NameAtom findName(const QByteArray& name);
+
+NameAtom findName(const char* name, int size);
+
+/// the name of an atom returned by internName
+const QByteArray& nameString(NameAtom atom);
+
+#endif // NAMEATOM_H
@@ -0,0 +1,190 @@
+//
+// Copyright (C) 2026 The fgqcanvas contributors
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as
+// published by the Free Software Foundation; either version 2 of the
+// License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+
+#include "propertyarena.h"
+
+#include <cstdlib>
+
+#include "localprop.h"
+
+static const size_t SlabBytes = 64 * 1024;
+static const size_t MinBlockBytes = 16;
+static const size_t MaxBlockBytes = MinBlockBytes << 8;
+
+// large blocks carry their list links in front, padded to keep alignment
+static const size_t LargeHeaderBytes = 32;
+
+static int sizeClassOf(size_t bytes)
+{
+    int sizeClass = 0;
+    size_t blockBytes = MinBlockBytes;
+    while (blockBytes < bytes) {
+        blockBytes <<= 1;
+        ++sizeClass;
+    }
+    return sizeClass;
+}
+
+PropertyArena::PropertyArena()
+{
+    static_assert(sizeof(LargeBlock) <= LargeHeaderBytes, "large block header too small");
+    for (auto& f : _freeLists) {
+        f = nullptr;
+    }
+}
+
+PropertyArena::~PropertyArena()
+{
+    release();
+}
+
+void* PropertyArena::allocate(size_t bytes)
+{
+    if (bytes > MaxBlockBytes) {
+        return allocateLarge(bytes);
+    }
+
+    const int sizeClass = sizeClassOf(bytes);
+    FreeBlock* f = _freeLists[sizeClass];
+    if (f) {
+        _freeLists[sizeClass] = f->next;
+        return f;
+    }
+
+    const size_t blockBytes = MinBlockBytes << sizeClass;
+    if (static_cast<size_t>(_slabEnd - _slabCursor) < blockBytes) {
+        // the tail of the old slab is abandoned: at most one block of
+        // the largest class, once per slab
+        char* slab = static_cast<char*>(std::malloc(SlabBytes));
+        if (!slab) {
+            throw std::bad_alloc();
+        }
+
+        _slabs.push_back(slab);
+        _reservedBytes += SlabBytes;
+        _slabCursor = slab;
+        _slabEnd = slab + SlabBytes;
+    }
+
+    void* result = _slabCursor;
+    _slabCursor += blockBytes;
+    return result;
+}
+
+void PropertyArena::deallocate(void* p, size_t bytes)
+{
+    if (!p) {
+        return;
+    }
+
+    if (bytes > MaxBlockBytes) {
+        deallocateLarge(p);
+        return;
+    }
+
+    const int sizeClass = sizeClassOf(bytes);
+    FreeBlock* f = static_cast<FreeBlock*>(p);
+    f->next = _freeLists[sizeClass];
+    _freeLists[sizeClass] = f;
+}
+
+void* PropertyArena::allocateLarge(size_t bytes)
+{
+    char* mem = static_cast<char*>(std::malloc(LargeHeaderBytes + bytes));
+    if (!mem) {
+        throw std::bad_alloc();
+    }
+
+    LargeBlock* block = reinterpret_cast<LargeBlock*>(mem);
+    block->prev = nullptr;
+    block->next = _largeBlocks;
+    block->bytes = bytes;
+    if (_largeBlocks) {
+        _largeBlocks->prev = block;
+    }
+    _largeBlocks = block;
+    _reservedBytes += bytes;
+    return mem + LargeHeaderBytes;
+}
+
+void PropertyArena::deallocateLarge(void* p)
+{
+    LargeBlock* block = reinterpret_cast<LargeBlock*>(static_cast<char*>(p) - LargeHeaderBytes);
+    if (block->prev) {
+        block->prev->next = block->next;
+    } else {
+        _largeBlocks = block->next;
+    }
+
+    if (block->next) {
+        block->next->prev = block->prev;
+    }
+
+    _reservedBytes -= block->bytes;
+    std::free(block);
+}
+
+void PropertyArena::addFinalizable(LocalProp* prop)
+{
+    prop->_finalizeSlot = static_cast<int>(_finalizable.size());
+    _finalizable.push_back(prop);
+}
+
+void PropertyArena::removeFinalizable(LocalProp* prop)
+{
+    const int slot = prop->_finalizeSlot;
+    LocalProp* last = _finalizable.back();
+    _finalizable[slot] = last;
+    last->_finalizeSlot = slot;
+    _finalizable.pop_back();
+    prop->_finalizeSlot = -1;
+}
+
+void PropertyArena::release()
+{
+    // observers may drop other observations, or delete themselves, as
+    // they're told, so take nodes one at a time. They may also observe
+    // other nodes, even ones already released: those are added back to the
+    // list, and so released again before the memory goes.
+    while (!_finalizable.empty()) {
+        LocalProp* prop = _finalizable.back();
+        _finalizable.pop_back();
+        prop->_finalizeSlot = -1;
+        _releasing = prop;
+        prop->releaseResources();
+    }
+    _releasing = nullptr;
+
+    for (char* slab : _slabs) {
+        std::free(slab);
+    }
+    _slabs.clear();
+    _slabCursor = _slabEnd = nullptr;
+
+    while (_largeBlocks) {
+        LargeBlock* next = _largeBlocks->next;
+        std::free(_largeBlocks);
+        _largeBlocks = next;
+    }
+
+    for (auto& f : _freeLists) {
+        f = nullptr;
+    }
+
+    _liveNodes = 0;
+    _reservedBytes = 0;
+}
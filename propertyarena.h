@@ -0,0 +1,161 @@
+//
+// Copyright (C) 2026 The fgqcanvas contributors
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as
+// published by the Free Software Foundation; either version 2 of the
+// License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+
+#ifndef PROPERTYARENA_H
+#define PROPERTYARENA_H
+
+#include <cstddef>
+#include <new>
+#include <vector>
+
+#include <QtGlobal>
+
+class LocalProp;
+
+/**
+ * @brief Memory for one property tree: LocalProp nodes and their child
+ * arrays are carved from large slabs, in power-of-two size classes. Freed
+ * blocks go on a per-class free list and are re-used, so steady-state
+ * churn doesn't touch the heap.
+ *
+ * release() drops a whole tree at once. Only nodes which hold a resource,
+ * a string value or observers, are visited; everything else is discarded
+ * with the slabs, without running destructors.
+ *
+ * Not thread-safe: a tree and its arena belong to the GUI thread.
+ */
+class PropertyArena
+{
+public:
+    PropertyArena();
+    ~PropertyArena();
+
+    PropertyArena(const PropertyArena&) = delete;
+    PropertyArena& operator=(const PropertyArena&) = delete;
+
+    void* allocate(size_t bytes);
+    void deallocate(void* p, size_t bytes);
+
+    /**
+     * @brief discard every node allocated from this arena, invalidating
+     * all pointers to them. Observers are told of the destruction as usual,
+     * but in no particular order, rather than children first.
+     */
+    void release();
+
+    size_t liveNodeCount() const
+    {
+        return _liveNodes;
+    }
+
+    /// bytes obtained from the heap, including free blocks held for re-use
+    size_t reservedBytes() const
+    {
+        return _reservedBytes;
+    }
+
+private:
+    friend class LocalProp;
+
+    struct LargeBlock
+    {
+        LargeBlock* prev;
+        LargeBlock* next;
+        size_t bytes;
+    };
+
+    struct FreeBlock
+    {
+        FreeBlock* next;
+    };
+
+    static const int SizeClassCount = 9; // 16 bytes to 4kbytes
+
+    void* allocateLarge(size_t bytes);
+    void deallocateLarge(void* p);
+
+    // nodes which must be visited by release()
+    void addFinalizable(LocalProp* prop);
+    void removeFinalizable(LocalProp* prop);
+
+    std::vector<char*> _slabs;
+    char* _slabCursor = nullptr;
+    char* _slabEnd = nullptr;
+    FreeBlock* _freeLists[SizeClassCount];
+    LargeBlock* _largeBlocks = nullptr;
+    std::vector<LocalProp*> _finalizable;
+    LocalProp* _releasing = nullptr; ///< being released, whose observers are detaching
+    size_t _liveNodes = 0;
+    size_t _reservedBytes = 0;
+};
+
+/**
+ * @brief Allocates from a PropertyArena, or the heap if it is null, so
+ * containers inside LocalProp follow the placement of their node.
+ */
+template <class T>
+class PropertyArenaAllocator
+{
+public:
+    using value_type = T;
+
+    PropertyArenaAllocator(PropertyArena* arena = nullptr) :
+        _arena(arena)
+    {}
+
+    template <class U>
+    PropertyArenaAllocator(const PropertyArenaAllocator<U>& other) :
+        _arena(other.arena())
+    {}
+
+    T* allocate(size_t n)
+    {
+        const size_t bytes = n * sizeof(T);
+        return static_cast<T*>(_arena ? _arena->allocate(bytes) : ::operator new(bytes));
+    }
+
+    void deallocate(T* p, size_t n)
+    {
+        if (_arena) {
+            _arena->deallocate(p, n * sizeof(T));
+        } else {
+            ::operator delete(p);
+        }
+    }
+
+    PropertyArena* arena() const
+    {
+        return _arena;
+    }
+
+    template <class U>
+    bool operator==(const PropertyArenaAllocator<U>& other) const
+    {
+        return _arena == other.arena();
+    }
+
+    template <class U>
+    bool operator!=(const PropertyArenaAllocator<U>& other) const
+    {
+        return _arena != other.arena();
+    }
+
+private:
+    PropertyArena* _arena;
+};
+
+#endif // PROPERTYARENA_H
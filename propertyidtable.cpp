@@ -0,0 +1,137 @@
+//
+// Copyright (C) 2026 The fgqcanvas contributors
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as
+// published by the Free Software Foundation; either version 2 of the
+// License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+
+#include "propertyidtable.h"
+
+#include "localprop.h"
+
+PropertyIdTable::Handle PropertyIdTable::handle(int id) const
+{
+    Handle h;
+    if (lookup(id)) {
+        h.id = id;
+        h.generation = _slots[id].generation;
+    }
+
+    return h;
+}
+
+// check id can be used, growing the table if necessary
+bool PropertyIdTable::claim(int id)
+{
+    if ((id < 0) || (id > MaxId)) {
+        return false;
+    }
+
+    if (static_cast<unsigned int>(id) >= _slots.size()) {
+        _slots.resize(id + 1);
+    }
+
+    return _slots[id].entry.prop == nullptr;
+}
+
+bool PropertyIdTable::insert(int id, LocalProp* prop)
+{
+    if (!claim(id)) {
+        return false;
+    }
+
+    // the same path announced again under a new id: the old id is stale,
+    // and must not keep pointing at the node once it's deleted
+    if (prop->mirrorId() >= 0) {
+        release(prop->mirrorId());
+    }
+
+    _slots[id].entry.prop = prop;
+    prop->setMirrorId(id);
+    ++_liveCount;
+    return true;
+}
+
+bool PropertyIdTable::insertPacked(int id, LocalProp* parent, NameAtom name, unsigned int index)
+{
+    PackedRun* run = parent->packedRun(name);
+    if (!run || !run->hasIndex(index) || !claim(id)) {
+        return false;
+    }
+
+    if (run->mirrorId(index) >= 0) {
+        release(run->mirrorId(index));
+    }
+
+    Entry& e = _slots[id].entry;
+    e.prop = parent;
+    e.packedName = name;
+    e.packedIndex = index;
+    run->setMirrorId(index, id);
+    ++_liveCount;
+    return true;
+}
+
+void PropertyIdTable::releaseSubtree(LocalProp* prop)
+{
+    // nodes created implicitly as intermediate path segments have no id
+    if (prop->mirrorId() >= 0) {
+        release(prop->mirrorId());
+    }
+
+    for (const PackedRun* run = prop->packedRuns(); run; run = run->next()) {
+        for (unsigned int i = 0; i < run->size(); ++i) {
+            if (run->mirrorId(i) >= 0) {
+                release(run->mirrorId(i));
+            }
+        }
+    }
+
+    for (auto child : prop->children()) {
+        releaseSubtree(child);
+    }
+}
+
+void PropertyIdTable::clear()
+{
+    // keep the generations, so handles from before stay invalid
+    for (Slot& s : _slots) {
+        if (s.entry.prop) {
+            s.entry = Entry();
+            ++s.generation;
+        }
+    }
+
+    _liveCount = 0;
+}
+
+void PropertyIdTable::release(int id)
+{
+    Slot& s = _slots[id];
+    if (!s.entry.prop) {
+        return;
+    }
+
+    if (s.entry.isPacked()) {
+        PackedRun* run = s.entry.prop->packedRun(s.entry.packedName);
+        if (run) {
+            run->setMirrorId(s.entry.packedIndex, -1);
+        }
+    } else {
+        s.entry.prop->setMirrorId(-1);
+    }
+
+    s.entry = Entry();
+    ++s.generation;
+    --_liveCount;
+}
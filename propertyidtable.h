@@ -0,0 +1,131 @@
+//
+// Copyright (C) 2026 The fgqcanvas contributors
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as
+// published by the Free Software Foundation; either version 2 of the
+// License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+
+#ifndef PROPERTYIDTABLE_H
+#define PROPERTYIDTABLE_H
+
+#include <vector>
+
+#include <QtGlobal>
+
+#include "nameatom.h"
+
+class LocalProp;
+
+/**
+ * @brief Maps PropertyTreeMirror ids to LocalProps. FlightGear allocates
+ * ids as small, dense integers, so they index a flat vector directly.
+ *
+ * Each slot carries a generation counter, bumped whenever its id is
+ * released, so a Handle taken earlier can detect that its property has
+ * since been removed (and the id possibly re-used).
+ *
+ * An id may also name one value of a PackedRun, eg coord[12] of a path:
+ * its Entry then refers to the parent holding the run.
+ */
+class PropertyIdTable
+{
+public:
+    struct Handle
+    {
+        int id = -1;
+        quint32 generation = 0;
+    };
+
+    struct Entry
+    {
+        LocalProp* prop = nullptr; ///< the node, or the parent of a packed value
+        NameAtom packedName = NoNameAtom;
+        unsigned int packedIndex = 0;
+
+        bool isPacked() const
+        {
+            return packedName != NoNameAtom;
+        }
+    };
+
+    /// ids above this are rejected, rather than growing the table without bound
+    static const int MaxId = 1 << 24;
+
+    /// the property for id, or nullptr if the id is unknown, was released,
+    /// or names a packed value
+    LocalProp* lookup(int id) const
+    {
+        const Entry* e = entry(id);
+        return (e && !e->isPacked()) ? e->prop : nullptr;
+    }
+
+    /// what id refers to, or nullptr if the id is unknown or was released
+    const Entry* entry(int id) const
+    {
+        if (static_cast<unsigned int>(id) >= _slots.size()) {
+            return nullptr;
+        }
+
+        const Entry& e = _slots[id].entry;
+        return e.prop ? &e : nullptr;
+    }
+
+    Handle handle(int id) const;
+
+    /// the property for h, or nullptr if it has been released since
+    LocalProp* resolve(const Handle& h) const
+    {
+        if (static_cast<unsigned int>(h.id) >= _slots.size()) {
+            return nullptr;
+        }
+
+        const Slot& s = _slots[h.id];
+        return ((s.generation == h.generation) && !s.entry.isPacked()) ? s.entry.prop : nullptr;
+    }
+
+    /// returns false if id is out of range or already in use
+    bool insert(int id, LocalProp* prop);
+
+    /// as insert, for the value name[index] packed on parent, which must exist
+    bool insertPacked(int id, LocalProp* parent, NameAtom name, unsigned int index);
+
+    /**
+     * @brief release the id of prop and of all its descendants, which are
+     * about to be deleted
+     */
+    void releaseSubtree(LocalProp* prop);
+
+    /// release a single id, eg of a packed value about to be removed
+    void release(int id);
+
+    void clear();
+
+    size_t liveCount() const
+    {
+        return _liveCount;
+    }
+
+private:
+    bool claim(int id);
+
+    struct Slot
+    {
+        Entry entry;
+        quint32 generation = 0;
+    };
+
+    std::vector<Slot> _slots;
+    size_t _liveCount = 0;
+};
+
+#endif // PROPERTYIDTABLE_H
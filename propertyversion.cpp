@@ -0,0 +1,143 @@
+//
+// Copyright (C) 2026 The fgqcanvas contributors
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as
+// published by the Free Software Foundation; either version 2 of the
+// License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+
+#include "propertyversion.h"
+
+#include <algorithm>
+#include <atomic>
+
+const PropVersionNode* PropVersionNode::childWithNameAndIndex(const NameIndexTuple& ni) const
+{
+    auto it = std::lower_bound(_children.begin(), _children.end(), ni,
+                               [](const PropVersionNodePtr& c, const NameIndexTuple& n) { return c->id() < n; });
+    if ((it != _children.end()) && ((*it)->id() == ni)) {
+        return it->get();
+    }
+
+    return nullptr;
+}
+
+const PropVersionNode* PropVersionNode::getWithPath(const PropPath& path) const
+{
+    const PropVersionNode* result = this;
+    for (const auto& ni : path.segments()) {
+        result = result->childWithNameAndIndex(ni);
+        if (!result) {
+            return nullptr;
+        }
+    }
+
+    return result;
+}
+
+PropValue PropVersionNode::value(const PropPath& path, PropValue defaultValue) const
+{
+    const PropVersionNode* n = getWithPath(path);
+    if (!n || n->value().isNull()) {
+        return defaultValue;
+    }
+
+    return n->value();
+}
+
+const PackedRunVersion* PropVersionNode::packedRun(NameAtom name) const
+{
+    for (const auto& run : _packedRuns) {
+        if (run.name == name) {
+            return &run;
+        }
+    }
+
+    return nullptr;
+}
+
+void PropTreePublisher::publish(LocalProp* root)
+{
+    const PropTreeVersionPtr previous = std::atomic_load(&_current);
+    if (previous && root && !root->_versionDirty) {
+        return; // nothing changed: the current version is still accurate
+    }
+
+    _lastBuiltCount = 0;
+    auto version = std::make_shared<PropTreeVersion>();
+    version->serial = ++_serial;
+    if (root) {
+        version->root = build(root, previous ? previous->root : PropVersionNodePtr());
+    }
+
+    std::atomic_store(&_current, PropTreeVersionPtr(version));
+}
+
+void PropTreePublisher::clear()
+{
+    std::atomic_store(&_current, PropTreeVersionPtr());
+}
+
+PropTreeVersionPtr PropTreePublisher::current() const
+{
+    return std::atomic_load(&_current);
+}
+
+PropVersionNodePtr PropTreePublisher::build(LocalProp* prop, const PropVersionNodePtr& previous)
+{
+    if (previous && !prop->_versionDirty) {
+        return previous;
+    }
+
+    std::shared_ptr<PropVersionNode> node(new PropVersionNode);
+    node->_id = prop->id();
+    node->_value = prop->value();
+    node->_position = prop->position();
+    node->_children.reserve(prop->children().size());
+
+    // both sides are sorted the same way, so match children up in one pass
+    const std::vector<PropVersionNodePtr> noChildren;
+    const auto& previousChildren = previous ? previous->_children : noChildren;
+    auto prevIt = previousChildren.begin();
+    for (LocalProp* child : prop->children()) {
+        while ((prevIt != previousChildren.end()) && ((*prevIt)->id() < child->id())) {
+            ++prevIt;
+        }
+
+        const bool matched = (prevIt != previousChildren.end()) && ((*prevIt)->id() == child->id());
+        node->_children.push_back(build(child, matched ? *prevIt : PropVersionNodePtr()));
+    }
+
+    for (const PackedRun* run = prop->packedRuns(); run; run = run->next()) {
+        PackedRunVersion v;
+        v.name = run->name();
+        v.type = run->type();
+        if (v.type == PackedRun::Type::Float) {
+            v.floats.assign(run->floatData(), run->floatData() + run->size());
+        } else {
+            v.ints.assign(run->intData(), run->intData() + run->size());
+        }
+
+        if (!run->isDense()) {
+            v.present.resize(run->size());
+            for (unsigned int i = 0; i < run->size(); ++i) {
+                v.present[i] = run->hasIndex(i);
+            }
+        }
+
+        node->_packedRuns.push_back(std::move(v));
+    }
+
+    prop->_versionDirty = false;
+    ++_lastBuiltCount;
+    return node;
+}
@@ -0,0 +1,154 @@
+//
+// Copyright (C) 2026 The fgqcanvas contributors
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as
+// published by the Free Software Foundation; either version 2 of the
+// License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+
+#ifndef PROPERTYVERSION_H
+#define PROPERTYVERSION_H
+
+#include <memory>
+#include <vector>
+
+#include "localprop.h"
+
+class PropVersionNode;
+
+using PropVersionNodePtr = std::shared_ptr<const PropVersionNode>;
+
+/**
+ * @brief The values of a PackedRun, as of one version.
+ */
+struct PackedRunVersion
+{
+    NameAtom name;
+    PackedRun::Type type;
+    std::vector<float> floats; ///< for Float runs
+    std::vector<int> ints;     ///< for Int runs
+    std::vector<bool> present; ///< empty when the run had no holes
+
+    size_t size() const
+    {
+        return (type == PackedRun::Type::Float) ? floats.size() : ints.size();
+    }
+
+    bool isDense() const
+    {
+        return present.empty();
+    }
+};
+
+/**
+ * @brief One node of a published version of a property tree. Immutable
+ * once published: any thread holding a pointer may read it, without
+ * locking, for as long as it keeps the pointer.
+ */
+class PropVersionNode
+{
+public:
+    const NameIndexTuple& id() const
+    {
+        return _id;
+    }
+
+    const PropValue& value() const
+    {
+        return _value;
+    }
+
+    unsigned int position() const
+    {
+        return _position;
+    }
+
+    /// sorted as LocalProp::children()
+    const std::vector<PropVersionNodePtr>& children() const
+    {
+        return _children;
+    }
+
+    const PropVersionNode* childWithNameAndIndex(const NameIndexTuple& ni) const;
+
+    const PropVersionNode* getWithPath(const PropPath& path) const;
+
+    PropValue value(const PropPath& path, PropValue defaultValue) const;
+
+    /// null if the node had no packed values called name
+    const PackedRunVersion* packedRun(NameAtom name) const;
+
+private:
+    friend class PropTreePublisher;
+
+    PropVersionNode() = default;
+
+    NameIndexTuple _id;
+    PropValue _value;
+    unsigned int _position = 0;
+    std::vector<PropVersionNodePtr> _children;
+    std::vector<PackedRunVersion> _packedRuns;
+};
+
+/**
+ * @brief A complete, consistent state of a property tree, as published
+ * after one frame of changes.
+ */
+struct PropTreeVersion
+{
+    quint64 serial = 0; ///< increases with each published version
+    PropVersionNodePtr root;
+};
+
+using PropTreeVersionPtr = std::shared_ptr<const PropTreeVersion>;
+
+/**
+ * @brief Publishes copy-on-write versions of a LocalProp tree, so that
+ * threads other than the one mutating the tree (eg the render thread) can
+ * read a consistent state of it without locks.
+ *
+ * The tree marks nodes whose value, packed values, position or children
+ * changed, up to the root. publish() rebuilds only those: every unchanged
+ * subtree is shared with the previous version. Each version is immutable,
+ * and stays alive while any reader holds it.
+ *
+ * A tree should have at most one publisher, since publishing clears the
+ * marks. publish() and clear() belong to the thread owning the tree;
+ * current() may be called from any thread.
+ */
+class PropTreePublisher
+{
+public:
+    /// publish the state of root as the next version
+    void publish(LocalProp* root);
+
+    /// forget the previous version, eg when the tree is replaced: the
+    /// next publish builds everything
+    void clear();
+
+    PropTreeVersionPtr current() const;
+
+    /// nodes built (rather than shared) by the last publish
+    size_t lastBuiltCount() const
+    {
+        return _lastBuiltCount;
+    }
+
+private:
+    PropVersionNodePtr build(LocalProp* prop, const PropVersionNodePtr& previous);
+
+    PropTreeVersionPtr _current;
+    quint64 _serial = 0;
+    size_t _lastBuiltCount = 0;
+};
+
+#endif // PROPERTYVERSION_H
@@ -0,0 +1,197 @@
+//
+// Copyright (C) 2026 The fgqcanvas contributors
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as
+// published by the Free Software Foundation; either version 2 of the
+// License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+
+#include "propvalue.h"
+
+#include <QDebug>
+#include <QLocale>
+
+void PropValue::assign(const PropValue& other)
+{
+    if (other._type == Type::String) {
+        if (_type == Type::String) {
+            _string = other._string;
+            return;
+        }
+
+        reset();
+        new (&_string) QString(other._string);
+        _type = Type::String;
+        return;
+    }
+
+    reset();
+    _type = other._type;
+    switch (_type) {
+    case Type::Bool:    _bool = other._bool; break;
+    case Type::Int:     _int = other._int; break;
+    case Type::Double:  _double = other._double; break;
+    default:            break;
+    }
+}
+
+void PropValue::assign(PropValue&& other)
+{
+    if (other._type != Type::String) {
+        assign(static_cast<const PropValue&>(other));
+        return;
+    }
+
+    if (_type == Type::String) {
+        _string.swap(other._string);
+    } else {
+        reset();
+        new (&_string) QString(std::move(other._string));
+        _type = Type::String;
+    }
+    other.reset();
+}
+
+PropValue PropValue::fromVariant(const QVariant& v)
+{
+    switch (static_cast<QMetaType::Type>(v.type())) {
+    case QMetaType::Bool:
+        return PropValue(v.toBool());
+
+    case QMetaType::Int:
+    case QMetaType::UInt:
+    case QMetaType::Short:
+    case QMetaType::UShort:
+        return PropValue(v.toInt());
+
+    case QMetaType::LongLong:
+    case QMetaType::ULongLong:
+    case QMetaType::Double:
+    case QMetaType::Float:
+        return PropValue(v.toDouble());
+
+    case QMetaType::QString:
+        return PropValue(v.toString());
+
+    case QMetaType::QByteArray:
+        return PropValue(v.toByteArray());
+
+    default:
+        return PropValue();
+    }
+}
+
+QVariant PropValue::toVariant() const
+{
+    switch (_type) {
+    case Type::Bool:    return QVariant(_bool);
+    case Type::Int:     return QVariant(_int);
+    case Type::Double:  return QVariant(_double);
+    case Type::String:  return QVariant(_string);
+    default:            return QVariant();
+    }
+}
+
+const QString& PropValue::stringRef() const
+{
+    static const QString nullString;
+    return (_type == Type::String) ? _string : nullString;
+}
+
+bool PropValue::toBool() const
+{
+    switch (_type) {
+    case Type::Bool:    return _bool;
+    case Type::Int:     return _int != 0;
+    case Type::Double:  return _double != 0.0;
+    case Type::String:
+        // as QVariant: empty, '0' and 'false' are false
+        return !(_string.isEmpty() || (_string == QLatin1String("0"))
+                 || (_string.compare(QLatin1String("false"), Qt::CaseInsensitive) == 0));
+    default:            return false;
+    }
+}
+
+int PropValue::toInt() const
+{
+    switch (_type) {
+    case Type::Bool:    return _bool ? 1 : 0;
+    case Type::Int:     return _int;
+    case Type::Double:  return static_cast<int>(qRound64(_double));
+    case Type::String:  return _string.toInt();
+    default:            return 0;
+    }
+}
+
+double PropValue::toDoubleSlow() const
+{
+    switch (_type) {
+    case Type::Bool:    return _bool ? 1.0 : 0.0;
+    case Type::Int:     return _int;
+    case Type::Double:  return _double;
+    case Type::String:  return _string.toDouble();
+    default:            return 0.0;
+    }
+}
+
+QString PropValue::toString() const
+{
+    switch (_type) {
+    case Type::Bool:    return _bool ? QStringLiteral("true") : QStringLiteral("false");
+    case Type::Int:     return QString::number(_int);
+    case Type::Double:  return QString::number(_double, 'g', QLocale::FloatingPointShortest);
+    case Type::String:  return _string;
+    default:            return QString();
+    }
+}
+
+QByteArray PropValue::toByteArray() const
+{
+    if (_type == Type::String) {
+        return _string.toUtf8();
+    }
+
+    return toString().toLatin1();
+}
+
+bool PropValue::operator==(const PropValue& other) const
+{
+    if (_type == other._type) {
+        switch (_type) {
+        case Type::Null:    return true;
+        case Type::Bool:    return _bool == other._bool;
+        case Type::Int:     return _int == other._int;
+        case Type::Double:  return _double == other._double;
+        case Type::String:  return _string == other._string;
+        }
+    }
+
+    if ((_type == Type::Null) || (other._type == Type::Null)
+        || (_type == Type::String) || (other._type == Type::String))
+    {
+        return false;
+    }
+
+    return toDouble() == other.toDouble();
+}
+
+QDebug operator<<(QDebug dbg, const PropValue& value)
+{
+    QDebugStateSaver saver(dbg);
+    switch (value.type()) {
+    case PropValue::Type::Null:     dbg.nospace() << "PropValue(null)"; break;
+    case PropValue::Type::Bool:     dbg << value.toBool(); break;
+    case PropValue::Type::String:   dbg << value.stringRef(); break;
+    default:                        dbg << value.toDouble(); break;
+    }
+    return dbg;
+}
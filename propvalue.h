@@ -0,0 +1,208 @@
+//
+// Copyright (C) 2026 The fgqcanvas contributors
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as
+// published by the Free Software Foundation; either version 2 of the
+// License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+
+#ifndef PROPVALUE_H
+#define PROPVALUE_H
+
+#include <new>
+#include <utility>
+
+#include <QString>
+#include <QVariant>
+
+class QDebug;
+
+/**
+ * @brief The value of a mirrored property: null, bool, int, double or a
+ * string. Numeric values are stored inline, with no allocation, and
+ * strings are implicitly shared, so copies are cheap.
+ *
+ * The conversions follow QVariant's, so code written against QVariant
+ * reads values the same way. Use toVariant() only where a QVariant is
+ * genuinely required, eg for QML or models.
+ */
+class PropValue
+{
+public:
+    enum class Type : quint8
+    {
+        Null,
+        Bool,
+        Int,
+        Double,
+        String
+    };
+
+    PropValue() :
+        _type(Type::Null),
+        _int(0)
+    {}
+
+    PropValue(bool b) :
+        _type(Type::Bool),
+        _bool(b)
+    {}
+
+    PropValue(int i) :
+        _type(Type::Int),
+        _int(i)
+    {}
+
+    PropValue(double d) :
+        _type(Type::Double),
+        _double(d)
+    {}
+
+    PropValue(const QString& s) :
+        _type(Type::String)
+    {
+        new (&_string) QString(s);
+    }
+
+    /// decoded as UTF-8
+    PropValue(const char* utf8) :
+        _type(Type::String)
+    {
+        new (&_string) QString(QString::fromUtf8(utf8));
+    }
+
+    /// decoded as UTF-8
+    PropValue(const QByteArray& utf8) :
+        _type(Type::String)
+    {
+        new (&_string) QString(QString::fromUtf8(utf8));
+    }
+
+    PropValue(const PropValue& other) :
+        _type(Type::Null),
+        _int(0)
+    {
+        assign(other);
+    }
+
+    PropValue(PropValue&& other) :
+        _type(Type::Null),
+        _int(0)
+    {
+        assign(std::move(other));
+    }
+
+    ~PropValue()
+    {
+        reset();
+    }
+
+    PropValue& operator=(const PropValue& other)
+    {
+        if (this != &other) {
+            assign(other);
+        }
+        return *this;
+    }
+
+    PropValue& operator=(PropValue&& other)
+    {
+        if (this != &other) {
+            assign(std::move(other));
+        }
+        return *this;
+    }
+
+    /// strings, numbers and bools convert; anything else becomes null
+    static PropValue fromVariant(const QVariant& v);
+
+    QVariant toVariant() const;
+
+    Type type() const
+    {
+        return _type;
+    }
+
+    bool isNull() const
+    {
+        return _type == Type::Null;
+    }
+
+    bool isString() const
+    {
+        return _type == Type::String;
+    }
+
+    /// the string, if this is one, otherwise a null QString. No conversion.
+    const QString& stringRef() const;
+
+    bool toBool() const;
+    int toInt() const;
+
+    double toDouble() const
+    {
+        // the common case, kept inline
+        return (_type == Type::Double) ? _double : toDoubleSlow();
+    }
+
+    float toFloat() const
+    {
+        return static_cast<float>(toDouble());
+    }
+
+    qreal toReal() const
+    {
+        return toDouble();
+    }
+
+    QString toString() const;
+    QByteArray toByteArray() const;
+
+    void clear()
+    {
+        reset();
+    }
+
+    /// numbers (including bools) compare by value; strings by content
+    bool operator==(const PropValue& other) const;
+
+    bool operator!=(const PropValue& other) const
+    {
+        return !(*this == other);
+    }
+
+private:
+    void reset()
+    {
+        if (_type == Type::String) {
+            _string.~QString();
+        }
+        _type = Type::Null;
+        _int = 0;
+    }
+
+    void assign(const PropValue& other);
+    void assign(PropValue&& other);
+    double toDoubleSlow() const;
+
+    Type _type;
+    union {
+        bool _bool;
+        int _int;
+        double _double;
+        QString _string;
+    };
+};
+
+QDebug operator<<(QDebug dbg, const PropValue& value);
+
+#endif // PROPVALUE_H
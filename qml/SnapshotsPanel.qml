@@ -41,7 +41,7 @@ Item {
             id: saveButton
             label: "Save"
             enabled: (saveTitleInput.text != "")
-            anchors.right: parent.right
+            anchors.right: saveBundleButton.left
             anchors.rightMargin: 8
             anchors.top: parent.top
             anchors.topMargin: 8
@@ -51,6 +51,21 @@ Item {
             }
         }
 
+        // includes images and fonts, for displays without a network
+        Button {
+            id: saveBundleButton
+            label: "Save Bundle"
+            enabled: (saveTitleInput.text != "")
+            anchors.right: parent.right
+            anchors.rightMargin: 8
+            anchors.top: parent.top
+            anchors.topMargin: 8
+
+            onClicked: {
+                _application.saveSnapshot(saveTitleInput.text, true);
+            }
+        }
+
 
         ListView {
             id: savedList
@@ -0,0 +1,272 @@
+//
+// Copyright (C) 2026 The fgqcanvas contributors
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as
+// published by the Free Software Foundation; either version 2 of the
+// License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+
+#include "sessionrecorder.h"
+
+#include <cctype>
+
+#include <QDateTime>
+#include <QDebug>
+#include <QDir>
+#include <QMutexLocker>
+#include <QThread>
+
+// beyond this, the writer can't keep up (or the disk is stalled)
+static const qint64 MaxPendingBytes = 32 * 1024 * 1024;
+
+// after failing to open a segment (eg the disk is full), try again after
+// this long rather than for every frame
+static const qint64 OpenRetryMsec = 10 * 1000;
+
+class SessionRecorder::WriterThread : public QThread
+{
+public:
+    WriterThread(SessionRecorder* recorder) :
+        _recorder(recorder)
+    {
+        setObjectName("SessionRecorder");
+    }
+
+protected:
+    void run() override
+    {
+        _recorder->writeLoop();
+    }
+
+private:
+    SessionRecorder* _recorder;
+};
+
+SessionRecorder::SessionRecorder(const QUrl& url, const QByteArray& rootPath, const Settings& settings) :
+    _url(url),
+    _rootPath(rootPath),
+    _settings(settings),
+    _sessionStart(QDateTime::currentMSecsSinceEpoch()),
+    _droppedFrames(0)
+{
+    _clock.start();
+
+    // canvases on different hosts may share a root path
+    QByteArray name = url.host().toUtf8() + "-" + QByteArray::number(url.port()) + rootPath;
+    for (char& c : name) {
+        if (!isalnum(static_cast<unsigned char>(c)) && (c != '-')) {
+            c = '_';
+        }
+    }
+
+    // segments are opened truncating, so make sure no other session (eg an
+    // earlier connection within the same second) has this prefix
+    const QString stamp = QDateTime::fromMSecsSinceEpoch(_sessionStart).toString("yyyyMMdd-hhmmss");
+    const QString base = QDir(settings.directory).filePath(QString::fromLatin1(name) + "-" + stamp);
+    _filePrefix = base;
+    for (int n = 1; QFile::exists(segmentPath(0)); ++n) {
+        _filePrefix = QString("%1-%2").arg(base).arg(n);
+    }
+
+    _thread.reset(new WriterThread(this));
+    _thread->start(QThread::LowPriority);
+}
+
+SessionRecorder::~SessionRecorder()
+{
+    {
+        QMutexLocker g(&_lock);
+        _stopping = true;
+        _wake.wakeAll();
+    }
+
+    _thread->wait();
+
+    if (_droppedFrames > 0) {
+        qWarning() << "session recording of" << _url << "dropped" << _droppedFrames << "frames";
+    }
+}
+
+void SessionRecorder::recordText(const QString& message)
+{
+    Record r;
+    r.type = RecordJsonFrame;
+    r.usec = _clock.nsecsElapsed() / 1000;
+    r.text = message; // implicitly shared, no copy here
+    enqueue(std::move(r), message.size() * 2);
+}
+
+void SessionRecorder::recordBinary(const QByteArray& message)
+{
+    Record r;
+    r.type = RecordBinaryFrame;
+    r.usec = _clock.nsecsElapsed() / 1000;
+    r.bytes = message;
+    enqueue(std::move(r), message.size());
+}
+
+void SessionRecorder::enqueue(Record&& r, qint64 size)
+{
+    QMutexLocker g(&_lock);
+    if (_pendingBytes + size > MaxPendingBytes) {
+        ++_droppedFrames;
+        if (!_dropping) {
+            // so a replay can tell that frames are missing from here
+            Record gap;
+            gap.type = RecordGap;
+            gap.usec = r.usec;
+            _pending.push_back(std::move(gap));
+            _dropping = true;
+            if (_pending.size() == 1) {
+                _wake.wakeOne();
+            }
+        }
+        return;
+    }
+
+    _dropping = false;
+
+    const bool wasEmpty = _pending.empty();
+    _pending.push_back(std::move(r));
+    _pendingBytes += size;
+    if (wasEmpty) {
+        _wake.wakeOne();
+    }
+}
+
+void SessionRecorder::writeLoop()
+{
+    std::vector<Record> batch;
+    for (;;) {
+        {
+            QMutexLocker g(&_lock);
+            while (_pending.empty() && !_stopping) {
+                _wake.wait(&_lock);
+            }
+
+            if (_pending.empty()) {
+                break; // stopping, and everything is written
+            }
+
+            batch.swap(_pending);
+            _pendingBytes = 0;
+        }
+
+        for (const Record& r : batch) {
+            write(r);
+        }
+        batch.clear();
+
+        if (_segment) {
+            _segment->flush();
+        }
+    }
+
+    _segment.reset();
+}
+
+void SessionRecorder::write(const Record& r)
+{
+    // pos() rather than size(), which would flush the buffer every record
+    if (_segment && (_segment->pos() >= _settings.segmentBytes)) {
+        _segment.reset();
+        ++_segmentNumber;
+    }
+
+    if (!_segment) {
+        if (_openFailed.isValid() && (_openFailed.elapsed() < OpenRetryMsec)) {
+            return;
+        }
+
+        if (!openSegment()) {
+            return;
+        }
+    }
+
+    QDataStream ds(_segment.get());
+    ds.setVersion(QDataStream::Qt_5_4);
+    ds << static_cast<quint8>(r.type) << r.usec;
+    if (r.type == RecordJsonFrame) {
+        ds << r.text.toUtf8();
+    } else {
+        ds << r.bytes; // empty for a gap
+    }
+}
+
+QString SessionRecorder::segmentPath(quint32 segmentNumber) const
+{
+    return QString("%1-%2.fgqrec").arg(_filePrefix).arg(segmentNumber, 4, 10, QChar('0'));
+}
+
+bool SessionRecorder::openSegment()
+{
+    const QString path = segmentPath(_segmentNumber);
+    std::unique_ptr<QFile> f(new QFile(path));
+    if (!f->open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        qWarning() << "failed to open session recording" << path << f->errorString();
+        _openFailed.start();
+        return false;
+    }
+
+    _openFailed.invalidate();
+
+    QDataStream ds(f.get());
+    ds.setVersion(QDataStream::Qt_5_4);
+    ds << SessionRecordMagic << SessionRecordVersion << _url << _rootPath
+       << _sessionStart << _segmentNumber;
+
+    _segment = std::move(f);
+    _segmentPaths.push_back(path);
+    while (static_cast<int>(_segmentPaths.size()) > qMax(1, _settings.maxSegments)) {
+        QFile::remove(_segmentPaths.front());
+        _segmentPaths.pop_front();
+    }
+
+    return true;
+}
+
+bool SessionReader::open(const QString& path)
+{
+    _file.reset(new QFile(path));
+    if (!_file->open(QIODevice::ReadOnly)) {
+        qWarning() << "failed to open session recording" << path << _file->errorString();
+        return false;
+    }
+
+    _stream.setDevice(_file.get());
+    _stream.setVersion(QDataStream::Qt_5_4);
+
+    quint32 magic, version;
+    _stream >> magic >> version;
+    if ((magic != SessionRecordMagic) || (version < SessionRecordMinimumVersion) ||
+        (version > SessionRecordVersion))
+    {
+        qWarning() << path << "is not a session recording, or an unsupported version";
+        return false;
+    }
+
+    _stream >> _url >> _rootPath >> _sessionStart >> _segmentNumber;
+    return (_stream.status() == QDataStream::Ok);
+}
+
+bool SessionReader::next(Record& r)
+{
+    if (!_file || _stream.atEnd()) {
+        return false;
+    }
+
+    quint8 type;
+    _stream >> type >> r.usec >> r.bytes;
+    r.type = static_cast<SessionRecordType>(type);
+    return (_stream.status() == QDataStream::Ok) &&
+            ((r.type == RecordJsonFrame) || (r.type == RecordBinaryFrame) || (r.type == RecordGap));
+}
@@ -0,0 +1,193 @@
+//
+// Copyright (C) 2026 The fgqcanvas contributors
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as
+// published by the Free Software Foundation; either version 2 of the
+// License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+
+#ifndef SESSIONRECORDER_H
+#define SESSIONRECORDER_H
+
+#include <atomic>
+#include <deque>
+#include <memory>
+#include <vector>
+
+#include <QByteArray>
+#include <QDataStream>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QMutex>
+#include <QString>
+#include <QUrl>
+#include <QWaitCondition>
+
+class QThread;
+
+/**
+ * A recording is a sequence of segment files, each a QDataStream (Qt 5.4
+ * format) holding a header and then frame records until the end of the file:
+ *
+ *   header:
+ *     quint32     magic, SessionRecordMagic
+ *     quint32     version, currently 2 (1 has no gap records)
+ *     QUrl        web-socket URL of the connection
+ *     QByteArray  root property path being mirrored
+ *     qint64      wall-clock start of the session, msec since the epoch
+ *     quint32     segment number within the session, from 0
+ *
+ *   record:
+ *     quint8      type, a SessionRecordType
+ *     qint64      monotonic time since the start of the session, usec
+ *     QByteArray  the frame exactly as received (JSON as UTF-8), empty
+ *                 for a gap
+ *
+ * Every segment carries the full header, so each can be replayed on its own.
+ * Segment files are named after the host, port and root path of the
+ * connection and the start of the session, and never overwrite another.
+ */
+
+const quint32 SessionRecordMagic = 0x46475152; // 'FGQR'
+const quint32 SessionRecordVersion = 2;
+const quint32 SessionRecordMinimumVersion = 1;
+
+enum SessionRecordType
+{
+    RecordJsonFrame = 0,
+    RecordBinaryFrame = 1,
+    RecordGap = 2 ///< frames were dropped here, so later ones may refer to unknown ids
+};
+
+/**
+ * @brief Writes the frames received by a connection into size-capped,
+ * rotating segment files. Recording only queues the frame; encoding and
+ * writing happen on a background thread, so it's cheap enough to leave
+ * enabled in production. If the writer falls too far behind, frames are
+ * dropped (and counted, and marked by a gap record) rather than buffering
+ * without limit.
+ */
+class SessionRecorder
+{
+public:
+    struct Settings
+    {
+        QString directory;
+        qint64 segmentBytes = 64 * 1024 * 1024;
+        int maxSegments = 8; ///< older segments are deleted
+    };
+
+    SessionRecorder(const QUrl& url, const QByteArray& rootPath, const Settings& settings);
+
+    /// writes out everything queued, then stops the writer thread
+    ~SessionRecorder();
+
+    // called from the thread receiving frames
+
+    void recordText(const QString& message);
+    void recordBinary(const QByteArray& message);
+
+    qint64 droppedFrames() const
+    {
+        return _droppedFrames;
+    }
+
+private:
+    class WriterThread;
+
+    struct Record
+    {
+        SessionRecordType type;
+        qint64 usec;
+        QString text; ///< converted to UTF-8 by the writer, not the caller
+        QByteArray bytes;
+    };
+
+    void enqueue(Record&& r, qint64 size);
+    void writeLoop();
+    void write(const Record& r);
+    QString segmentPath(quint32 segmentNumber) const;
+    bool openSegment();
+
+    const QUrl _url;
+    const QByteArray _rootPath;
+    const Settings _settings;
+    const qint64 _sessionStart;
+    QString _filePrefix;
+    QElapsedTimer _clock;
+
+    QMutex _lock;
+    QWaitCondition _wake;
+    std::vector<Record> _pending;
+    qint64 _pendingBytes = 0;
+    bool _stopping = false;
+    std::atomic<qint64> _droppedFrames;
+    bool _dropping = false; ///< a gap is recorded for the frames being dropped
+
+    // only touched by the writer thread
+    std::unique_ptr<QFile> _segment;
+    quint32 _segmentNumber = 0;
+    QElapsedTimer _openFailed; ///< since opening a segment last failed
+    std::deque<QString> _segmentPaths;
+
+    std::unique_ptr<QThread> _thread;
+};
+
+/**
+ * @brief Reads back the segment files written by SessionRecorder, in order.
+ */
+class SessionReader
+{
+public:
+    struct Record
+    {
+        SessionRecordType type = RecordJsonFrame;
+        qint64 usec = 0;
+        QByteArray bytes;
+    };
+
+    /// returns false if the file can't be opened or isn't a session recording
+    bool open(const QString& path);
+
+    /// returns false at the end of the file, or if it is truncated
+    bool next(Record& r);
+
+    QUrl url() const
+    {
+        return _url;
+    }
+
+    QByteArray rootPath() const
+    {
+        return _rootPath;
+    }
+
+    qint64 sessionStart() const
+    {
+        return _sessionStart;
+    }
+
+    quint32 segmentNumber() const
+    {
+        return _segmentNumber;
+    }
+
+private:
+    std::unique_ptr<QFile> _file;
+    QDataStream _stream;
+    QUrl _url;
+    QByteArray _rootPath;
+    qint64 _sessionStart = 0;
+    quint32 _segmentNumber = 0;
+};
+
+#endif // SESSIONRECORDER_H
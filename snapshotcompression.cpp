@@ -0,0 +1,237 @@
+//
+// Copyright (C) 2026 The fgqcanvas contributors
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as
+// published by the Free Software Foundation; either version 2 of the
+// License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+
+#include "snapshotcompression.h"
+
+#include <cstring>
+
+#include <QDataStream>
+#include <QDebug>
+#include <QFile>
+
+#include "snapshotfile.h"
+
+static const char CompressedSnapshotSignature[8] = { 'F', 'G', 'Q', 'C', 'S', 'N', 'P', 'Z' };
+
+// qCompress output can exceed its input, for incompressible data
+static const quint32 MaxCompressedChunkSize = CompressedSnapshotChunkSize + (CompressedSnapshotChunkSize / 8) + 64;
+
+SnapshotCompressor::SnapshotCompressor(QIODevice* output, const QString& name) :
+    _output(output)
+{
+    _chunk.reserve(CompressedSnapshotChunkSize);
+
+    _output->write(CompressedSnapshotSignature, sizeof(CompressedSnapshotSignature));
+    QDataStream ds(_output);
+    ds.setVersion(QDataStream::Qt_5_4);
+    ds << SnapshotFormat::Version << name << static_cast<quint32>(CompressedSnapshotChunkSize);
+    _ok = (ds.status() == QDataStream::Ok);
+
+    open(QIODevice::WriteOnly);
+}
+
+SnapshotCompressor::~SnapshotCompressor()
+{
+    close();
+}
+
+void SnapshotCompressor::close()
+{
+    if (!isOpen()) {
+        return;
+    }
+
+    writeChunk();
+
+    QDataStream ds(_output);
+    ds.setVersion(QDataStream::Qt_5_4);
+    ds << static_cast<quint32>(0);
+    _ok &= (ds.status() == QDataStream::Ok);
+
+    QIODevice::close();
+}
+
+qint64 SnapshotCompressor::readData(char*, qint64)
+{
+    return -1;
+}
+
+qint64 SnapshotCompressor::writeData(const char* data, qint64 size)
+{
+    qint64 written = 0;
+    while (written < size) {
+        const qint64 space = CompressedSnapshotChunkSize - _chunk.size();
+        const qint64 n = qMin(space, size - written);
+        _chunk.append(data + written, static_cast<int>(n));
+        written += n;
+
+        if (_chunk.size() == CompressedSnapshotChunkSize) {
+            writeChunk();
+        }
+    }
+
+    return _ok ? size : -1;
+}
+
+void SnapshotCompressor::writeChunk()
+{
+    if (_chunk.isEmpty()) {
+        return;
+    }
+
+    const QByteArray compressed = qCompress(_chunk);
+    _chunk.resize(0); // keeps the capacity
+
+    QDataStream ds(_output);
+    ds.setVersion(QDataStream::Qt_5_4);
+    ds << static_cast<quint32>(compressed.size());
+    ds.writeRawData(compressed.constData(), compressed.size());
+    _ok &= (ds.status() == QDataStream::Ok);
+}
+
+bool hasCompressedSnapshotSignature(QIODevice* device)
+{
+    return device->peek(sizeof(CompressedSnapshotSignature)) ==
+            QByteArray::fromRawData(CompressedSnapshotSignature, sizeof(CompressedSnapshotSignature));
+}
+
+// read up to the first chunk, leaving the stream positioned there
+static bool readHeader(QDataStream& ds, QString* name, quint32* chunkSize)
+{
+    char signature[sizeof(CompressedSnapshotSignature)];
+    if ((ds.readRawData(signature, sizeof(signature)) != sizeof(signature)) ||
+        (memcmp(signature, CompressedSnapshotSignature, sizeof(signature)) != 0))
+    {
+        return false;
+    }
+
+    quint32 version;
+    ds >> version >> *name >> *chunkSize;
+    return (ds.status() == QDataStream::Ok) &&
+            (version >= SnapshotFormat::MinimumVersion) && (version <= SnapshotFormat::Version) &&
+            (*chunkSize > 0) && (*chunkSize <= CompressedSnapshotChunkSize);
+}
+
+bool readCompressedSnapshotName(QIODevice* device, QString* name)
+{
+    QDataStream ds(device);
+    ds.setVersion(QDataStream::Qt_5_4);
+    quint32 chunkSize;
+    return readHeader(ds, name, &chunkSize);
+}
+
+bool decompressSnapshot(QIODevice* input, QIODevice* output)
+{
+    QDataStream ds(input);
+    ds.setVersion(QDataStream::Qt_5_4);
+    QString name;
+    quint32 chunkSize;
+    if (!readHeader(ds, &name, &chunkSize)) {
+        return false;
+    }
+
+    QByteArray compressed;
+    for (;;) {
+        quint32 size;
+        ds >> size;
+        if (ds.status() != QDataStream::Ok) {
+            return false; // truncated: the terminator is missing
+        }
+
+        if (size == 0) {
+            return true;
+        }
+
+        // check the sizes before qUncompress trusts them
+        if ((size < 4) || (size > MaxCompressedChunkSize)) {
+            return false;
+        }
+
+        compressed.resize(static_cast<int>(size));
+        if (ds.readRawData(compressed.data(), static_cast<int>(size)) != static_cast<int>(size)) {
+            return false;
+        }
+
+        const uchar* p = reinterpret_cast<const uchar*>(compressed.constData());
+        const quint32 expanded = (quint32(p[0]) << 24) | (quint32(p[1]) << 16) | (quint32(p[2]) << 8) | p[3];
+        if (expanded > chunkSize) {
+            return false;
+        }
+
+        const QByteArray chunk = qUncompress(compressed);
+        if (chunk.isEmpty() || (static_cast<quint32>(chunk.size()) != expanded)) {
+            return false;
+        }
+
+        if (output->write(chunk) != chunk.size()) {
+            return false;
+        }
+    }
+}
+
+SnapshotSaver::SnapshotSaver(std::unique_ptr<SnapshotWriter> writer, const QString& fileName,
+                             QObject* pr) :
+    QThread(pr),
+    _writer(std::move(writer)),
+    _fileName(fileName)
+{
+    setObjectName("SnapshotSaver");
+}
+
+SnapshotSaver::~SnapshotSaver()
+{
+    wait();
+}
+
+bool writeCompressedSnapshot(const SnapshotWriter& writer, const QString& fileName)
+{
+    const QString partialName = fileName + ".part";
+    QFile f(partialName);
+    if (!f.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        qWarning() << "failed to open" << partialName << f.errorString();
+        return false;
+    }
+
+    SnapshotCompressor compressor(&f, writer.name());
+    const bool written = writer.write(&compressor);
+    compressor.close();
+    f.close();
+
+    if (!written || !compressor.ok() || (f.error() != QFile::NoError)) {
+        qWarning() << "failed to write snapshot" << fileName << f.errorString();
+        QFile::remove(partialName);
+        return false;
+    }
+
+    QFile::remove(fileName);
+    if (!QFile::rename(partialName, fileName)) {
+        qWarning() << "failed to rename snapshot to" << fileName;
+        QFile::remove(partialName);
+        return false;
+    }
+
+    return true;
+}
+
+void SnapshotSaver::run()
+{
+    const bool ok = writeCompressedSnapshot(*_writer, _fileName);
+
+    // the trees are no longer needed once written
+    _writer.reset();
+    emit saved(ok);
+}
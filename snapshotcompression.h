@@ -0,0 +1,138 @@
+//
+// Copyright (C) 2026 The fgqcanvas contributors
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as
+// published by the Free Software Foundation; either version 2 of the
+// License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+
+#ifndef SNAPSHOTCOMPRESSION_H
+#define SNAPSHOTCOMPRESSION_H
+
+#include <memory>
+
+#include <QByteArray>
+#include <QIODevice>
+#include <QString>
+#include <QThread>
+
+class SnapshotWriter;
+
+/**
+ * A compressed snapshot wraps a version 2 or 3 snapshot (see SnapshotFormat)
+ * in independently compressed chunks, so it can be written and read with
+ * a buffer of one chunk, whatever the size of the snapshot:
+ *
+ *   char[8]     signature, CompressedSnapshotSignature
+ *   then, as a QDataStream (Qt 5.4 format):
+ *   quint32     version of the wrapped snapshot
+ *   QString     snapshot name, readable without decompressing
+ *   quint32     largest uncompressed chunk size
+ *   chunks:
+ *     quint32     compressed size, 0 ends the file
+ *     bytes       qCompress() output: a big-endian uncompressed size,
+ *                 then a zlib stream
+ */
+const int CompressedSnapshotChunkSize = 256 * 1024;
+
+/**
+ * @brief A write-only device compressing into a snapshot container. Bytes
+ * are buffered until a chunk is full, so at most one chunk is held.
+ */
+class SnapshotCompressor : public QIODevice
+{
+public:
+    /// output must be open, and stay so until close()
+    SnapshotCompressor(QIODevice* output, const QString& name);
+    ~SnapshotCompressor();
+
+    /// writes the remaining chunk and the terminator
+    void close() override;
+
+    bool isSequential() const override
+    {
+        return true;
+    }
+
+    /// false if the output failed at some point
+    bool ok() const
+    {
+        return _ok;
+    }
+
+protected:
+    qint64 readData(char* data, qint64 maxSize) override;
+    qint64 writeData(const char* data, qint64 size) override;
+
+private:
+    void writeChunk();
+
+    QIODevice* _output;
+    QByteArray _chunk;
+    bool _ok = true;
+};
+
+/**
+ * @brief Stream-decompress a compressed snapshot from input to output,
+ * a chunk at a time. Returns false if input is truncated or corrupt.
+ */
+bool decompressSnapshot(QIODevice* input, QIODevice* output);
+
+/// whether device starts with the compressed snapshot signature
+bool hasCompressedSnapshotSignature(QIODevice* device);
+
+/// the name stored in a compressed snapshot, without decompressing it
+bool readCompressedSnapshotName(QIODevice* device, QString* name);
+
+/**
+ * @brief Compress writer into fileName. The file is written under a
+ * temporary name and renamed once complete, so a partial snapshot is never
+ * found under fileName. Returns false, with a warning, if writing failed.
+ */
+bool writeCompressedSnapshot(const SnapshotWriter& writer, const QString& fileName);
+
+/**
+ * @brief Compresses a snapshot and writes it to a file on a thread of its
+ * own, so that saving large canvases doesn't stall the GUI. See
+ * writeCompressedSnapshot().
+ *
+ * The writer must already hold everything to save: building it reads the
+ * property trees, which belong to the GUI thread.
+ */
+class SnapshotSaver : public QThread
+{
+    Q_OBJECT
+public:
+    SnapshotSaver(std::unique_ptr<SnapshotWriter> writer, const QString& fileName,
+                  QObject* pr = nullptr);
+
+    /// waits for the file to be written
+    ~SnapshotSaver();
+
+    QString fileName() const
+    {
+        return _fileName;
+    }
+
+signals:
+    /// emitted from the saving thread, once the file is complete or failed
+    void saved(bool ok);
+
+protected:
+    void run() override;
+
+private:
+    std::unique_ptr<SnapshotWriter> _writer;
+    const QString _fileName;
+};
+
+#endif // SNAPSHOTCOMPRESSION_H
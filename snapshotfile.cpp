@@ -0,0 +1,628 @@
+//
+// Copyright (C) 2026 The fgqcanvas contributors
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as
+// published by the Free Software Foundation; either version 2 of the
+// License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+
+#include "snapshotfile.h"
+
+#include <climits>
+#include <cstddef>
+#include <cstring>
+
+#include <QDebug>
+#include <QDir>
+#include <QImage>
+#include <QIODevice>
+#include <QTemporaryFile>
+
+#include "localprop.h"
+#include "snapshotcompression.h"
+
+using namespace SnapshotFormat;
+
+static const char Signature[8] = { 'F', 'G', 'Q', 'C', 'S', 'N', 'A', 'P' };
+
+static_assert(sizeof(Header) % 8 == 0, "snapshot tables follow the header 8-byte aligned");
+static_assert(sizeof(Node) == 32, "snapshot node records are packed");
+static_assert(sizeof(Asset) == 40, "snapshot asset records are packed");
+
+// version 2 headers end before the asset offsets
+static const quint64 Version2HeaderSize = offsetof(Header, assetOffset);
+
+// bundled images are stored in the format the raster paint engine draws
+// fastest, so restoring them is a copy rather than a conversion
+static const QImage::Format AssetImageFormat = QImage::Format_ARGB32_Premultiplied;
+
+SnapshotWriter::SnapshotWriter(const QString& name) :
+    _name(name)
+{
+    _nameString = addString(name.toUtf8());
+}
+
+quint32 SnapshotWriter::addString(const QByteArray& utf8)
+{
+    auto it = _stringIndex.constFind(utf8);
+    if (it != _stringIndex.constEnd()) {
+        return it.value();
+    }
+
+    const quint32 index = static_cast<quint32>(_strings.size());
+    _strings.push_back(String{static_cast<quint32>(_stringData.size()),
+                              static_cast<quint32>(utf8.size())});
+    _stringData.append(utf8);
+    _stringIndex.insert(utf8, index);
+    return index;
+}
+
+Node SnapshotWriter::nodeRecord(const LocalProp* prop)
+{
+    Node n;
+    memset(&n, 0, sizeof(Node));
+    n.name = addString(prop->name());
+    n.index = prop->index();
+    n.position = prop->position();
+    n.firstChild = NoIndex;
+    n.firstRun = NoIndex;
+
+    const PropValue& v = prop->value();
+    switch (v.type()) {
+    case PropValue::Type::Null:
+        n.valueType = ValueType::Null;
+        break;
+    case PropValue::Type::Bool:
+        n.valueType = ValueType::Bool;
+        n.value = v.toBool() ? 1 : 0;
+        break;
+    case PropValue::Type::Int:
+        n.valueType = ValueType::Int;
+        n.value = static_cast<quint32>(v.toInt());
+        break;
+    case PropValue::Type::Double:
+        n.valueType = ValueType::Double;
+        n.value = static_cast<quint32>(_doubles.size());
+        _doubles.push_back(v.toDouble());
+        break;
+    case PropValue::Type::String:
+        n.valueType = ValueType::String;
+        n.value = addString(v.toString().toUtf8());
+        break;
+    }
+
+    return n;
+}
+
+void SnapshotWriter::addCanvas(const QUrl& url, const QByteArray& rootPath,
+                               const QRectF& destRect, const LocalProp* root)
+{
+    Canvas c;
+    c.url = addString(url.toString().toUtf8());
+    c.rootPath = addString(rootPath);
+    c.destRect[0] = destRect.x();
+    c.destRect[1] = destRect.y();
+    c.destRect[2] = destRect.width();
+    c.destRect[3] = destRect.height();
+    c.rootNode = NoIndex;
+    c.nodeCount = 0;
+
+    if (root) {
+        // breadth-first, so that each node's children are contiguous
+        const size_t base = _nodes.size();
+        std::vector<const LocalProp*> order;
+        order.push_back(root);
+        _nodes.push_back(nodeRecord(root));
+
+        for (size_t i = 0; i < order.size(); ++i) {
+            const LocalProp* prop = order[i];
+            const auto& children = prop->children();
+            if (!children.empty()) {
+                _nodes[base + i].firstChild = static_cast<quint32>(base + order.size());
+                _nodes[base + i].childCount = static_cast<quint32>(children.size());
+                for (const LocalProp* child : children) {
+                    order.push_back(child);
+                    _nodes.push_back(nodeRecord(child));
+                }
+            }
+
+            quint16 runCount = 0;
+            for (const PackedRun* run = prop->packedRuns(); run; run = run->next()) {
+                Run r;
+                r.name = addString(nameString(run->name()));
+                r.type = static_cast<quint32>(run->type());
+                r.size = run->size();
+                if (run->type() == PackedRun::Type::Float) {
+                    r.first = static_cast<quint32>(_floats.size());
+                    _floats.insert(_floats.end(), run->floatData(), run->floatData() + run->size());
+                } else {
+                    r.first = static_cast<quint32>(_ints.size());
+                    _ints.insert(_ints.end(), run->intData(), run->intData() + run->size());
+                }
+
+                r.presence = NoIndex;
+                if (!run->isDense()) {
+                    r.presence = static_cast<quint32>(_presence.size());
+                    for (unsigned int index = 0; index < run->size(); ++index) {
+                        _presence.push_back(run->hasIndex(index) ? 1 : 0);
+                    }
+                }
+
+                if (runCount == 0) {
+                    _nodes[base + i].firstRun = static_cast<quint32>(_runs.size());
+                }
+
+                _runs.push_back(r);
+                ++runCount;
+            }
+
+            _nodes[base + i].runCount = runCount;
+        }
+
+        c.rootNode = static_cast<quint32>(base);
+        c.nodeCount = static_cast<quint32>(order.size());
+    }
+
+    _canvases.push_back(c);
+}
+
+// tables start 8-byte aligned, so each can be read in place from a mapping
+static quint64 alignedOffset(quint64 offset)
+{
+    return (offset + 7) & ~quint64(7);
+}
+
+void SnapshotWriter::addAsset(const QByteArray& path, Asset asset, const char* data)
+{
+    asset.path = addString(path);
+
+    // each asset starts aligned too, so images can be used in place
+    _assetData.append(QByteArray(static_cast<int>(alignedOffset(_assetData.size()) - _assetData.size()), '\0'));
+    asset.offset = static_cast<quint64>(_assetData.size());
+    _assetData.append(data, static_cast<int>(asset.size));
+
+    _assetIndex.insert(path, static_cast<quint32>(_assets.size()));
+    _assets.push_back(asset);
+}
+
+void SnapshotWriter::addImage(const QByteArray& path, const QImage& image)
+{
+    if (image.isNull() || hasAsset(path)) {
+        return;
+    }
+
+    const QImage converted = image.convertToFormat(AssetImageFormat);
+    Asset a;
+    memset(&a, 0, sizeof(Asset));
+    a.type = AssetType::Image;
+    a.width = static_cast<quint32>(converted.width());
+    a.height = static_cast<quint32>(converted.height());
+    a.bytesPerLine = static_cast<quint32>(converted.bytesPerLine());
+    a.format = static_cast<quint32>(converted.format());
+    a.size = static_cast<quint64>(converted.byteCount());
+    addAsset(path, a, reinterpret_cast<const char*>(converted.constBits()));
+}
+
+void SnapshotWriter::addFont(const QByteArray& path, const QByteArray& fontData)
+{
+    if (fontData.isEmpty() || hasAsset(path)) {
+        return;
+    }
+
+    Asset a;
+    memset(&a, 0, sizeof(Asset));
+    a.type = AssetType::Font;
+    a.size = static_cast<quint64>(fontData.size());
+    addAsset(path, a, fontData.constData());
+}
+
+template <class T>
+static quint64 layoutTable(quint64& end, size_t count)
+{
+    const quint64 offset = alignedOffset(end);
+    end = offset + (count * sizeof(T));
+    return offset;
+}
+
+template <class T>
+static bool writeTable(QIODevice* device, quint64& pos, quint64 offset, const T* data, size_t count)
+{
+    static const char padding[8] = {};
+    if (device->write(padding, static_cast<qint64>(offset - pos)) != static_cast<qint64>(offset - pos)) {
+        return false;
+    }
+
+    const qint64 bytes = static_cast<qint64>(count * sizeof(T));
+    if ((bytes > 0) && (device->write(reinterpret_cast<const char*>(data), bytes) != bytes)) {
+        return false;
+    }
+
+    pos = offset + static_cast<quint64>(bytes);
+    return true;
+}
+
+bool SnapshotWriter::write(QIODevice* device) const
+{
+    Header h;
+    memset(&h, 0, sizeof(Header));
+    memcpy(h.signature, Signature, sizeof(Signature));
+    h.version = Version;
+    h.byteOrder = ByteOrderMark;
+    h.name = _nameString;
+    h.canvasCount = static_cast<quint32>(_canvases.size());
+    h.stringCount = static_cast<quint32>(_strings.size());
+    h.nodeCount = static_cast<quint32>(_nodes.size());
+    h.runCount = static_cast<quint32>(_runs.size());
+    h.doubleCount = static_cast<quint32>(_doubles.size());
+    h.floatCount = static_cast<quint32>(_floats.size());
+    h.intCount = static_cast<quint32>(_ints.size());
+    h.presenceCount = static_cast<quint32>(_presence.size());
+    h.assetCount = static_cast<quint32>(_assets.size());
+
+    // lay the tables out first, so the header can be written before them
+    quint64 end = sizeof(Header);
+    h.canvasOffset = layoutTable<Canvas>(end, _canvases.size());
+    h.stringOffset = layoutTable<String>(end, _strings.size());
+    h.stringDataOffset = layoutTable<char>(end, static_cast<size_t>(_stringData.size()));
+    h.stringDataSize = static_cast<quint64>(_stringData.size());
+    h.nodeOffset = layoutTable<Node>(end, _nodes.size());
+    h.runOffset = layoutTable<Run>(end, _runs.size());
+    h.doubleOffset = layoutTable<double>(end, _doubles.size());
+    h.floatOffset = layoutTable<float>(end, _floats.size());
+    h.intOffset = layoutTable<qint32>(end, _ints.size());
+    h.presenceOffset = layoutTable<quint8>(end, _presence.size());
+    h.assetOffset = layoutTable<Asset>(end, _assets.size());
+    h.assetDataOffset = layoutTable<char>(end, static_cast<size_t>(_assetData.size()));
+    h.assetDataSize = static_cast<quint64>(_assetData.size());
+
+    quint64 pos = 0;
+    return writeTable(device, pos, 0, &h, 1) &&
+            writeTable(device, pos, h.canvasOffset, _canvases.data(), _canvases.size()) &&
+            writeTable(device, pos, h.stringOffset, _strings.data(), _strings.size()) &&
+            writeTable(device, pos, h.stringDataOffset, _stringData.constData(), static_cast<size_t>(_stringData.size())) &&
+            writeTable(device, pos, h.nodeOffset, _nodes.data(), _nodes.size()) &&
+            writeTable(device, pos, h.runOffset, _runs.data(), _runs.size()) &&
+            writeTable(device, pos, h.doubleOffset, _doubles.data(), _doubles.size()) &&
+            writeTable(device, pos, h.floatOffset, _floats.data(), _floats.size()) &&
+            writeTable(device, pos, h.intOffset, _ints.data(), _ints.size()) &&
+            writeTable(device, pos, h.presenceOffset, _presence.data(), _presence.size()) &&
+            writeTable(device, pos, h.assetOffset, _assets.data(), _assets.size()) &&
+            writeTable(device, pos, h.assetDataOffset, _assetData.constData(), static_cast<size_t>(_assetData.size()));
+}
+
+bool SnapshotFile::hasSignature(QIODevice* device)
+{
+    return (device->peek(sizeof(Signature)) == QByteArray::fromRawData(Signature, sizeof(Signature))) ||
+            hasCompressedSnapshotSignature(device);
+}
+
+QString SnapshotFile::readName(const QString& fileName)
+{
+    QFile f(fileName);
+    if (!f.open(QIODevice::ReadOnly)) {
+        return {};
+    }
+
+    QString name;
+    if (hasCompressedSnapshotSignature(&f)) {
+        readCompressedSnapshotName(&f, &name);
+        return name;
+    }
+
+    f.close();
+    Ptr snapshot = open(fileName);
+    return snapshot ? snapshot->name() : QString();
+}
+
+SnapshotFile::Ptr SnapshotFile::open(const QString& fileName)
+{
+    std::shared_ptr<SnapshotFile> file(new SnapshotFile);
+    if (!file->map(fileName)) {
+        return {};
+    }
+
+    if (!file->validate()) {
+        qWarning() << "invalid snapshot file:" << fileName;
+        return {};
+    }
+
+    file->_atoms.assign(file->_header->stringCount, NoNameAtom);
+    return file;
+}
+
+bool SnapshotFile::map(const QString& fileName)
+{
+    _file.reset(new QFile(fileName));
+    if (!_file->open(QIODevice::ReadOnly)) {
+        qWarning() << "failed to open snapshot" << fileName << _file->errorString();
+        return false;
+    }
+
+    if (hasCompressedSnapshotSignature(_file.get())) {
+        // expand into a temporary file a chunk at a time, and map that, so
+        // memory use doesn't grow with the snapshot
+        std::unique_ptr<QTemporaryFile> expanded(new QTemporaryFile(QDir::temp().filePath("fgcanvassnapshot")));
+        if (!expanded->open()) {
+            qWarning() << "failed to create a temporary file for" << fileName << expanded->errorString();
+            return false;
+        }
+
+        if (!decompressSnapshot(_file.get(), expanded.get()) || !expanded->flush()) {
+            qWarning() << "corrupt compressed snapshot:" << fileName;
+            return false;
+        }
+
+        _file = std::move(expanded);
+    }
+
+    _size = static_cast<quint64>(_file->size());
+    if (_size < Version2HeaderSize) {
+        qWarning() << "not a snapshot file:" << fileName;
+        return false;
+    }
+
+    _data = _file->map(0, _file->size());
+    if (!_data) {
+        qWarning() << "failed to map snapshot" << fileName << _file->errorString();
+        return false;
+    }
+
+    _header = reinterpret_cast<const Header*>(_data);
+    if (memcmp(_header->signature, Signature, sizeof(Signature)) != 0) {
+        qWarning() << "not a version 2 or 3 snapshot:" << fileName;
+        return false;
+    }
+
+    if ((_header->version < MinimumVersion) || (_header->version > Version) ||
+        (_header->byteOrder != ByteOrderMark) ||
+        ((_header->version > MinimumVersion) && (_size < sizeof(Header))))
+    {
+        qWarning() << "unsupported snapshot version or byte order:" << fileName;
+        return false;
+    }
+
+    return true;
+}
+
+// check a table lies within the file, and is aligned for reading in place
+template <class T>
+static bool locateTable(const uchar* data, quint64 size, quint64 offset, quint64 count,
+                        const T*& table)
+{
+    if ((offset % 8) || (offset > size) || (count > (size - offset) / sizeof(T))) {
+        return false;
+    }
+
+    table = reinterpret_cast<const T*>(data + offset);
+    return true;
+}
+
+bool SnapshotFile::validate()
+{
+    const Header& h = *_header;
+    if (!locateTable(_data, _size, h.canvasOffset, h.canvasCount, _canvases) ||
+        !locateTable(_data, _size, h.stringOffset, h.stringCount, _strings) ||
+        !locateTable(_data, _size, h.stringDataOffset, h.stringDataSize, _stringData) ||
+        !locateTable(_data, _size, h.nodeOffset, h.nodeCount, _nodes) ||
+        !locateTable(_data, _size, h.runOffset, h.runCount, _runs) ||
+        !locateTable(_data, _size, h.doubleOffset, h.doubleCount, _doubles) ||
+        !locateTable(_data, _size, h.floatOffset, h.floatCount, _floats) ||
+        !locateTable(_data, _size, h.intOffset, h.intCount, _ints) ||
+        !locateTable(_data, _size, h.presenceOffset, h.presenceCount, _presence))
+    {
+        return false;
+    }
+
+    if (h.name >= h.stringCount) {
+        return false;
+    }
+
+    for (quint32 i = 0; i < h.stringCount; ++i) {
+        const String& s = _strings[i];
+        if (static_cast<quint64>(s.offset) + s.size > h.stringDataSize) {
+            return false;
+        }
+    }
+
+    for (quint32 i = 0; i < h.runCount; ++i) {
+        const Run& r = _runs[i];
+        const quint64 end = static_cast<quint64>(r.first) + r.size;
+        if ((r.name >= h.stringCount) ||
+            ((r.type == static_cast<quint32>(PackedRun::Type::Float)) && (end > h.floatCount)) ||
+            ((r.type == static_cast<quint32>(PackedRun::Type::Int)) && (end > h.intCount)) ||
+            (r.type > static_cast<quint32>(PackedRun::Type::Int)) ||
+            ((r.presence != NoIndex) && (static_cast<quint64>(r.presence) + r.size > h.presenceCount)))
+        {
+            return false;
+        }
+    }
+
+    for (quint32 i = 0; i < h.nodeCount; ++i) {
+        const Node& n = _nodes[i];
+        if ((n.name >= h.stringCount) ||
+            ((n.runCount > 0) && (static_cast<quint64>(n.firstRun) + n.runCount > h.runCount)) ||
+            ((n.valueType == ValueType::Double) && (n.value >= h.doubleCount)) ||
+            ((n.valueType == ValueType::String) && (n.value >= h.stringCount)) ||
+            (n.valueType > ValueType::String))
+        {
+            return false;
+        }
+    }
+
+    // each canvas must be a tree laid out breadth-first: the child ranges
+    // follow one another without gaps or overlaps, so restoring can't loop
+    // or visit a node twice
+    for (quint32 c = 0; c < h.canvasCount; ++c) {
+        const Canvas& canvas = _canvases[c];
+        if ((canvas.url >= h.stringCount) || (canvas.rootPath >= h.stringCount)) {
+            return false;
+        }
+
+        if (canvas.rootNode == NoIndex) {
+            continue;
+        }
+
+        const quint64 end = static_cast<quint64>(canvas.rootNode) + canvas.nodeCount;
+        if ((canvas.nodeCount == 0) || (end > h.nodeCount)) {
+            return false;
+        }
+
+        // breadth-first, so each level ends where the children of the one
+        // before it do; restoring recurses per level, so cap how many
+        quint64 nextChild = canvas.rootNode + 1;
+        quint64 levelEnd = nextChild;
+        quint32 depth = 0;
+        for (quint64 i = canvas.rootNode; i < end; ++i) {
+            if (i == levelEnd) {
+                if (++depth >= MaxDepth) {
+                    return false;
+                }
+                levelEnd = nextChild;
+            }
+
+            const Node& n = _nodes[i];
+            if (n.childCount == 0) {
+                continue;
+            }
+
+            if ((n.firstChild != nextChild) || (nextChild + n.childCount > end)) {
+                return false;
+            }
+            nextChild += n.childCount;
+        }
+
+        if (nextChild != end) {
+            return false;
+        }
+    }
+
+    return (h.version == MinimumVersion) || validateAssets();
+}
+
+bool SnapshotFile::validateAssets()
+{
+    const Header& h = *_header;
+    if (!locateTable(_data, _size, h.assetOffset, h.assetCount, _assets) ||
+        !locateTable(_data, _size, h.assetDataOffset, h.assetDataSize, _assetData))
+    {
+        return false;
+    }
+
+    for (quint32 i = 0; i < h.assetCount; ++i) {
+        const Asset& a = _assets[i];
+        if ((a.path >= h.stringCount) || (a.offset % 8) ||
+            (a.offset > h.assetDataSize) || (a.size > h.assetDataSize - a.offset))
+        {
+            return false;
+        }
+
+        if (a.type == AssetType::Image) {
+            // the pixels must cover the whole image, in the format we wrote
+            if ((a.format != static_cast<quint32>(AssetImageFormat)) || (a.width == 0) ||
+                (a.height == 0) || (a.width > 0x7fff) || (a.height > 0x7fff) ||
+                (a.bytesPerLine < a.width * 4) ||
+                (static_cast<quint64>(a.bytesPerLine) * a.height > a.size))
+            {
+                return false;
+            }
+        } else if ((a.type != AssetType::Font) || (a.size == 0) || (a.size > INT_MAX)) {
+            return false;
+        }
+
+        _assetIndex.insert(string(a.path), i);
+    }
+
+    return true;
+}
+
+QString SnapshotFile::name() const
+{
+    return QString::fromUtf8(string(_header->name));
+}
+
+QUrl SnapshotFile::canvasUrl(int canvas) const
+{
+    return QUrl(QString::fromUtf8(string(_canvases[canvas].url)));
+}
+
+QByteArray SnapshotFile::canvasRootPath(int canvas) const
+{
+    // a deep copy: the connection keeps it beyond the mapping
+    const QByteArray path = string(_canvases[canvas].rootPath);
+    return QByteArray(path.constData(), path.size());
+}
+
+QRectF SnapshotFile::canvasDestRect(int canvas) const
+{
+    const double* r = _canvases[canvas].destRect;
+    return QRectF(r[0], r[1], r[2], r[3]);
+}
+
+QByteArray SnapshotFile::string(quint32 index) const
+{
+    const String& s = _strings[index];
+    return QByteArray::fromRawData(_stringData + s.offset, static_cast<int>(s.size));
+}
+
+NameAtom SnapshotFile::atom(quint32 index) const
+{
+    if (_atoms[index] == NoNameAtom) {
+        const String& s = _strings[index];
+        _atoms[index] = internName(_stringData + s.offset, static_cast<int>(s.size));
+    }
+
+    return _atoms[index];
+}
+
+QImage SnapshotFile::image(const QByteArray& path) const
+{
+    auto it = _assetIndex.constFind(path);
+    if ((it == _assetIndex.constEnd()) || (_assets[it.value()].type != AssetType::Image)) {
+        return {};
+    }
+
+    // copied, so the image doesn't depend on the mapping staying open
+    const Asset& a = _assets[it.value()];
+    return QImage(_assetData + a.offset, static_cast<int>(a.width), static_cast<int>(a.height),
+                  static_cast<int>(a.bytesPerLine), AssetImageFormat).copy();
+}
+
+QByteArray SnapshotFile::fontData(const QByteArray& path) const
+{
+    auto it = _assetIndex.constFind(path);
+    if ((it == _assetIndex.constEnd()) || (_assets[it.value()].type != AssetType::Font)) {
+        return {};
+    }
+
+    const Asset& a = _assets[it.value()];
+    return QByteArray::fromRawData(reinterpret_cast<const char*>(_assetData + a.offset),
+                                   static_cast<int>(a.size));
+}
+
+PropValue SnapshotFile::value(const Node& node) const
+{
+    switch (node.valueType) {
+    case ValueType::Bool:
+        return PropValue(node.value != 0);
+    case ValueType::Int:
+        return PropValue(static_cast<int>(node.value));
+    case ValueType::Double:
+        return PropValue(_doubles[node.value]);
+    case ValueType::String:
+        return PropValue(string(node.value));
+    case ValueType::Null:
+    default:
+        break;
+    }
+
+    return {};
+}
@@ -0,0 +1,344 @@
+//
+// Copyright (C) 2026 The fgqcanvas contributors
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as
+// published by the Free Software Foundation; either version 2 of the
+// License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+
+#ifndef SNAPSHOTFILE_H
+#define SNAPSHOTFILE_H
+
+#include <memory>
+#include <vector>
+
+#include <QByteArray>
+#include <QFile>
+#include <QHash>
+#include <QRectF>
+#include <QString>
+#include <QUrl>
+
+#include "nameatom.h"
+#include "propvalue.h"
+
+class LocalProp;
+class QIODevice;
+class QImage;
+
+/**
+ * @brief The on-disk layout of version 2 and 3 .fgcanvassnapshot files, designed
+ * to be read straight from a memory mapping. After the header, at 8-byte
+ * aligned offsets it gives, come:
+ *
+ * - canvases: the connection settings, and the range of nodes holding
+ *   each canvas' property tree;
+ * - a string table: every distinct name, string value, URL and path once,
+ *   as offset / size pairs into a block of UTF-8;
+ * - a flat node table, breadth-first per canvas, so the children of a node
+ *   are contiguous and found by index;
+ * - typed value columns: doubles, and the values of packed runs (see
+ *   PackedRun) as float / int arrays, with a presence byte per index for
+ *   runs which have holes. Int and bool node values are held inline;
+ * - version 3 only: bundled assets, so the snapshot displays without the
+ *   network or the disk cache. Images are stored decoded, in the pixel
+ *   format painting uses, and fonts as their font files.
+ *
+ * Numbers are in the byte order of the machine which wrote the file. Files
+ * of the other order are rejected rather than swapped: snapshots are for
+ * restoring on the device which took them.
+ *
+ * Version 1 files, a QDataStream of LocalProp::saveToStream records, don't
+ * start with the signature, and are still read by ApplicationController.
+ */
+namespace SnapshotFormat
+{
+    const quint32 Version = 3;
+    const quint32 MinimumVersion = 2; ///< without assets
+    const quint32 ByteOrderMark = 0x01020304;
+    const quint32 NoIndex = 0xffffffff;
+    const quint32 MaxDepth = 256; ///< tree levels, files with more are rejected
+
+    enum class ValueType : quint8
+    {
+        Null,
+        Bool,   ///< inline
+        Int,    ///< inline
+        Double, ///< index into the doubles
+        String  ///< index into the strings
+    };
+
+    struct Header
+    {
+        char signature[8];
+        quint32 version;
+        quint32 byteOrder;
+        quint32 name; ///< string index
+        quint32 canvasCount;
+        quint32 stringCount;
+        quint32 nodeCount;
+        quint32 runCount;
+        quint32 doubleCount;
+        quint32 floatCount;
+        quint32 intCount;
+        quint32 presenceCount;
+        quint32 assetCount; ///< zero, and reserved, in version 2
+        quint64 canvasOffset;
+        quint64 stringOffset;
+        quint64 stringDataOffset;
+        quint64 stringDataSize;
+        quint64 nodeOffset;
+        quint64 runOffset;
+        quint64 doubleOffset;
+        quint64 floatOffset;
+        quint64 intOffset;
+        quint64 presenceOffset;
+        // version 3
+        quint64 assetOffset;
+        quint64 assetDataOffset;
+        quint64 assetDataSize;
+    };
+
+    struct Canvas
+    {
+        quint32 url;      ///< string index
+        quint32 rootPath; ///< string index
+        quint32 rootNode; ///< NoIndex if the canvas had no tree
+        quint32 nodeCount;
+        double destRect[4];
+    };
+
+    struct String
+    {
+        quint32 offset;
+        quint32 size;
+    };
+
+    struct Node
+    {
+        quint32 name; ///< string index
+        quint32 index;
+        quint32 position;
+        quint32 firstChild;
+        quint32 childCount;
+        quint32 firstRun;
+        quint16 runCount;
+        ValueType valueType;
+        quint8 padding;
+        quint32 value; ///< see ValueType
+    };
+
+    struct Run
+    {
+        quint32 name; ///< string index
+        quint32 type; ///< PackedRun::Type
+        quint32 size;
+        quint32 first;    ///< index into the floats or ints
+        quint32 presence; ///< index into the presence bytes, NoIndex if dense
+    };
+
+    enum class AssetType : quint32
+    {
+        Image,
+        Font
+    };
+
+    struct Asset
+    {
+        quint32 path; ///< string index, as the canvases refer to it
+        AssetType type;
+        quint32 width;        ///< images only
+        quint32 height;       ///< images only
+        quint32 bytesPerLine; ///< images only
+        quint32 format;       ///< QImage::Format, images only
+        quint64 offset;       ///< into the asset data, 8-byte aligned
+        quint64 size;
+    };
+} // namespace SnapshotFormat
+
+/**
+ * @brief Builds a snapshot of the current SnapshotFormat::Version. Adding canvases
+ * copies their trees into the tables; writing them out only reads the
+ * writer, so can happen on another thread (see SnapshotSaver).
+ */
+class SnapshotWriter
+{
+public:
+    explicit SnapshotWriter(const QString& name);
+
+    QString name() const
+    {
+        return _name;
+    }
+
+    /// root may be null, for a canvas which never connected
+    void addCanvas(const QUrl& url, const QByteArray& rootPath, const QRectF& destRect,
+                   const LocalProp* root);
+
+    /// whether an asset was bundled under path already, perhaps by
+    /// another canvas
+    bool hasAsset(const QByteArray& path) const
+    {
+        return _assetIndex.contains(path);
+    }
+
+    /// bundle a decoded image, converting it for painting if needed
+    void addImage(const QByteArray& path, const QImage& image);
+
+    /// bundle the contents of a font file
+    void addFont(const QByteArray& path, const QByteArray& fontData);
+
+    /// write the file to device sequentially, without assembling it in
+    /// memory first; false if writing fails
+    bool write(QIODevice* device) const;
+
+private:
+    quint32 addString(const QByteArray& utf8);
+    SnapshotFormat::Node nodeRecord(const LocalProp* prop);
+    void addAsset(const QByteArray& path, SnapshotFormat::Asset asset, const char* data);
+
+    const QString _name;
+    quint32 _nameString;
+    std::vector<SnapshotFormat::Canvas> _canvases;
+    std::vector<SnapshotFormat::String> _strings;
+    QByteArray _stringData;
+    QHash<QByteArray, quint32> _stringIndex;
+    std::vector<SnapshotFormat::Node> _nodes;
+    std::vector<SnapshotFormat::Run> _runs;
+    std::vector<double> _doubles;
+    std::vector<float> _floats;
+    std::vector<qint32> _ints;
+    std::vector<quint8> _presence;
+    std::vector<SnapshotFormat::Asset> _assets;
+    QByteArray _assetData;
+    QHash<QByteArray, quint32> _assetIndex;
+};
+
+/**
+ * @brief A version 2 or 3 snapshot, mapped into memory and validated, but
+ * otherwise not read: restoring a canvas builds its LocalProp tree in one
+ * pass over the node table (see LocalProp::restoreFromSnapshot), and can
+ * wait until the tree is first needed. Names are interned once per distinct
+ * string, rather than once per node.
+ *
+ * Shared by the connections restored from it, which release it once their
+ * trees are built.
+ */
+class SnapshotFile
+{
+public:
+    using Ptr = std::shared_ptr<const SnapshotFile>;
+
+    /// null, with a warning, if fileName isn't a valid version 2 or 3 snapshot
+    static Ptr open(const QString& fileName);
+
+    /// whether device starts like a version 2 or 3 snapshot, compressed (see
+    /// SnapshotCompressor) or not, without reading it
+    static bool hasSignature(QIODevice* device);
+
+    /// the name of a version 2 or 3 snapshot, without restoring it
+    static QString readName(const QString& fileName);
+
+    QString name() const;
+
+    int canvasCount() const
+    {
+        return static_cast<int>(_header->canvasCount);
+    }
+
+    QUrl canvasUrl(int canvas) const;
+    QByteArray canvasRootPath(int canvas) const;
+    QRectF canvasDestRect(int canvas) const;
+
+    /// NoIndex if the canvas had no tree
+    quint32 canvasRootNode(int canvas) const
+    {
+        return _canvases[canvas].rootNode;
+    }
+
+    const SnapshotFormat::Node& node(quint32 index) const
+    {
+        return _nodes[index];
+    }
+
+    const SnapshotFormat::Run& run(quint32 index) const
+    {
+        return _runs[index];
+    }
+
+    /// the raw bytes of a string, pointing into the mapping
+    QByteArray string(quint32 index) const;
+
+    /// a string as a name, interned on first use
+    NameAtom atom(quint32 index) const;
+
+    PropValue value(const SnapshotFormat::Node& node) const;
+
+    const float* floats(const SnapshotFormat::Run& run) const
+    {
+        return _floats + run.first;
+    }
+
+    const qint32* ints(const SnapshotFormat::Run& run) const
+    {
+        return _ints + run.first;
+    }
+
+    /// one byte per index of run, non-zero where a value is present; null
+    /// if the run has no holes
+    const quint8* presence(const SnapshotFormat::Run& run) const
+    {
+        return (run.presence == SnapshotFormat::NoIndex) ? nullptr : _presence + run.presence;
+    }
+
+    bool hasAssets() const
+    {
+        return !_assetIndex.isEmpty();
+    }
+
+    /// a copy of the image bundled as path, ready for painting without
+    /// conversion; null if it wasn't bundled
+    QImage image(const QByteArray& path) const;
+
+    /// the font file bundled as path, pointing into the mapping; empty if
+    /// it wasn't bundled
+    QByteArray fontData(const QByteArray& path) const;
+
+private:
+    SnapshotFile() = default;
+
+    bool map(const QString& fileName);
+    bool validate();
+    bool validateAssets();
+
+    std::unique_ptr<QFile> _file; ///< a temporary file for compressed snapshots
+    const uchar* _data = nullptr;
+    quint64 _size = 0;
+
+    const SnapshotFormat::Header* _header = nullptr;
+    const SnapshotFormat::Canvas* _canvases = nullptr;
+    const SnapshotFormat::String* _strings = nullptr;
+    const char* _stringData = nullptr;
+    const SnapshotFormat::Node* _nodes = nullptr;
+    const SnapshotFormat::Run* _runs = nullptr;
+    const double* _doubles = nullptr;
+    const float* _floats = nullptr;
+    const qint32* _ints = nullptr;
+    const quint8* _presence = nullptr;
+    const SnapshotFormat::Asset* _assets = nullptr;
+    const uchar* _assetData = nullptr;
+    QHash<QByteArray, quint32> _assetIndex; ///< keys point into the mapping
+
+    mutable std::vector<NameAtom> _atoms; ///< NoNameAtom until interned
+};
+
+#endif // SNAPSHOTFILE_H
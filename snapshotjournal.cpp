@@ -0,0 +1,404 @@
+//
+// Copyright (C) 2026 The fgqcanvas contributors
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as
+// published by the Free Software Foundation; either version 2 of the
+// License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+
+#include "snapshotjournal.h"
+
+#include <algorithm>
+#include <cctype>
+
+#include <QDebug>
+#include <QDir>
+#include <QMutexLocker>
+#include <QThread>
+
+#include "canvasframecodec.h"
+#include "snapshotcompression.h"
+
+// beyond this, the writer can't keep up (or the disk is stalled)
+static const qint64 MaxPendingBytes = 32 * 1024 * 1024;
+
+static const char CheckpointPrefix[] = "checkpoint-";
+static const char CheckpointSuffix[] = ".fgcanvassnapshot";
+static const char JournalPrefix[] = "journal-";
+static const char JournalSuffix[] = ".fgqjournal";
+
+static QString sequenceFile(const QString& directory, const char* prefix, quint32 sequence,
+                            const char* suffix)
+{
+    return QDir(directory).filePath(QString("%1%2%3").arg(prefix).arg(sequence, 8, 10, QChar('0')).arg(suffix));
+}
+
+// the sequence number of a checkpoint or journal file, from its name
+static bool fileSequence(const QString& fileName, quint32* sequence)
+{
+    const int start = fileName.indexOf('-') + 1;
+    const int end = fileName.indexOf('.', start);
+    if ((start <= 0) || (end <= start)) {
+        return false;
+    }
+
+    bool ok;
+    *sequence = fileName.mid(start, end - start).toUInt(&ok);
+    return ok;
+}
+
+// a rough count of the bytes a frame takes, queued or journaled
+static qint64 frameBytes(const CanvasFrame& frame)
+{
+    qint64 bytes = static_cast<qint64>((frame.removed.size() * 4) + (frame.changed.size() * 12));
+    for (const auto& c : frame.created) {
+        bytes += 16 + c.path.size();
+    }
+    return bytes;
+}
+
+class SnapshotJournal::WriterThread : public QThread
+{
+public:
+    WriterThread(SnapshotJournal* journal) :
+        _journal(journal)
+    {
+        setObjectName("SnapshotJournal");
+    }
+
+protected:
+    void run() override
+    {
+        _journal->writeLoop();
+    }
+
+private:
+    SnapshotJournal* _journal;
+};
+
+SnapshotJournal::SnapshotJournal(const QUrl& url, const QByteArray& rootPath, const Settings& settings) :
+    _settings(settings),
+    _directory(canvasDirectory(settings.directory, url, rootPath))
+{
+    QDir d(_directory);
+    if (!d.exists()) {
+        d.mkpath(".");
+    }
+
+    // continue the numbering of an earlier run, so that its state stays
+    // recoverable until our first checkpoint is complete
+    const QStringList existing = d.entryList(QStringList() << QString("*%1").arg(CheckpointSuffix)
+                                                           << QString("*%1").arg(JournalSuffix),
+                                             QDir::Files);
+    for (const QString& fileName : existing) {
+        quint32 sequence;
+        if (fileSequence(fileName, &sequence)) {
+            _sequence = qMax(_sequence, sequence + 1);
+        }
+    }
+
+    _thread.reset(new WriterThread(this));
+    _thread->start(QThread::LowPriority);
+}
+
+SnapshotJournal::~SnapshotJournal()
+{
+    {
+        QMutexLocker g(&_lock);
+        _stopping = true;
+        _wake.wakeAll();
+    }
+
+    _thread->wait();
+}
+
+QString SnapshotJournal::canvasDirectory(const QString& settingsDirectory, const QUrl& url,
+                                         const QByteArray& rootPath)
+{
+    QByteArray name = url.host().toUtf8() + "-" + QByteArray::number(url.port()) + rootPath;
+    for (char& c : name) {
+        if (!isalnum(static_cast<unsigned char>(c)) && (c != '-')) {
+            c = '_';
+        }
+    }
+
+    return QDir(settingsDirectory).filePath(QString::fromLatin1(name));
+}
+
+void SnapshotJournal::checkpoint(std::unique_ptr<SnapshotWriter> writer, IdPaths&& ids)
+{
+    Entry e;
+    e.type = EntryType::Checkpoint;
+    e.sequence = _sequence++;
+    e.writer = std::move(writer);
+    e.ids = std::move(ids);
+    enqueue(std::move(e), 0, true);
+
+    _started = true;
+    _dropping = false;
+    _journalBytes = 0;
+    _sinceCheckpoint.start();
+}
+
+void SnapshotJournal::append(const CanvasFrame& frame)
+{
+    if (!_started || _dropping) {
+        return;
+    }
+
+    Entry e;
+    e.type = EntryType::Frame;
+    e.frame = frame;
+    const qint64 size = frameBytes(frame);
+    if (!enqueue(std::move(e), size, false)) {
+        // the journal misses a frame from here: mark the gap, so replaying
+        // stops before it, and drop the rest until the next checkpoint
+        Entry gap;
+        gap.type = EntryType::Gap;
+        enqueue(std::move(gap), 0, true);
+        _dropping = true;
+        qWarning() << "journal of" << _directory << "fell behind, dropping frames until the next checkpoint";
+        return;
+    }
+
+    _journalBytes += size;
+}
+
+bool SnapshotJournal::checkpointDue() const
+{
+    if (!_started) {
+        return false;
+    }
+
+    return _dropping || (_journalBytes >= _settings.checkpointJournalBytes) ||
+            ((_journalBytes > 0) && (_sinceCheckpoint.elapsed() >= _settings.checkpointIntervalMsec));
+}
+
+bool SnapshotJournal::enqueue(Entry&& e, qint64 size, bool always)
+{
+    QMutexLocker g(&_lock);
+    if (!always && (_pendingBytes + size > MaxPendingBytes)) {
+        return false;
+    }
+
+    const bool wasEmpty = _pending.empty();
+    _pending.push_back(std::move(e));
+    _pendingBytes += size;
+    if (wasEmpty) {
+        _wake.wakeOne();
+    }
+
+    return true;
+}
+
+void SnapshotJournal::writeLoop()
+{
+    std::vector<Entry> batch;
+    for (;;) {
+        {
+            QMutexLocker g(&_lock);
+            while (_pending.empty() && !_stopping) {
+                _wake.wait(&_lock);
+            }
+
+            if (_pending.empty()) {
+                break; // stopping, and everything is written
+            }
+
+            batch.swap(_pending);
+            _pendingBytes = 0;
+        }
+
+        for (Entry& e : batch) {
+            write(e);
+        }
+        batch.clear();
+
+        if (_journal) {
+            _journal->flush();
+        }
+    }
+
+    _journal.reset();
+}
+
+void SnapshotJournal::write(Entry& e)
+{
+    if (e.type == EntryType::Checkpoint) {
+        writeCheckpoint(e);
+        return;
+    }
+
+    if (!_journal) {
+        return;
+    }
+
+    QDataStream ds(_journal.get());
+    ds.setVersion(QDataStream::Qt_5_4);
+    if (e.type == EntryType::Frame) {
+        ds << static_cast<quint8>(JournalFrame) << encodeBinaryFrame(e.frame);
+    } else {
+        ds << static_cast<quint8>(JournalGap) << QByteArray();
+    }
+}
+
+void SnapshotJournal::writeCheckpoint(Entry& e)
+{
+    // start the new journal first: until the checkpoint is complete, the
+    // previous checkpoint is recovered, and both journals replayed over it
+    _journal.reset();
+    const QString path = sequenceFile(_directory, JournalPrefix, e.sequence, JournalSuffix);
+    std::unique_ptr<QFile> f(new QFile(path));
+    if (f->open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        QDataStream ds(f.get());
+        ds.setVersion(QDataStream::Qt_5_4);
+        ds << SnapshotJournalMagic << SnapshotJournalVersion << e.sequence
+           << static_cast<quint32>(e.ids.size());
+        for (const IdPath& idPath : e.ids) {
+            ds << static_cast<qint32>(idPath.id) << idPath.path;
+        }
+
+        f->flush();
+        _journal = std::move(f);
+    } else {
+        qWarning() << "failed to open journal" << path << f->errorString();
+    }
+
+    e.ids = IdPaths();
+    const bool written = writeCompressedSnapshot(*e.writer,
+                                                 sequenceFile(_directory, CheckpointPrefix, e.sequence, CheckpointSuffix));
+    e.writer.reset();
+
+    if (written) {
+        removeBefore(e.sequence);
+    }
+}
+
+void SnapshotJournal::removeBefore(quint32 sequence)
+{
+    QDir d(_directory);
+    const QStringList files = d.entryList(QStringList() << QString("%1*").arg(CheckpointPrefix)
+                                                        << QString("%1*").arg(JournalPrefix),
+                                          QDir::Files);
+    for (const QString& fileName : files) {
+        quint32 fileSeq;
+        if (fileSequence(fileName, &fileSeq) && (fileSeq < sequence)) {
+            d.remove(fileName);
+        }
+    }
+}
+
+bool SnapshotJournalReader::open(const QString& directory)
+{
+    _directory = directory;
+
+    std::vector<quint32> sequences;
+    const QStringList checkpoints = QDir(directory).entryList(QStringList() << QString("%1*%2").arg(CheckpointPrefix).arg(CheckpointSuffix),
+                                                              QDir::Files);
+    for (const QString& fileName : checkpoints) {
+        quint32 sequence;
+        if (fileSequence(fileName, &sequence)) {
+            sequences.push_back(sequence);
+        }
+    }
+
+    // the latest which can be read: an older one only remains if a newer
+    // one wasn't completed
+    std::sort(sequences.begin(), sequences.end());
+    for (auto it = sequences.rbegin(); it != sequences.rend(); ++it) {
+        SnapshotFile::Ptr file = SnapshotFile::open(sequenceFile(directory, CheckpointPrefix, *it, CheckpointSuffix));
+        if (file && (file->canvasCount() == 1)) {
+            _checkpoint = file;
+            _sequence = *it;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+bool SnapshotJournalReader::nextJournal()
+{
+    if (_stopped || !_checkpoint) {
+        return false;
+    }
+
+    if (!_first) {
+        ++_sequence;
+    }
+    _first = false;
+    _ids.clear();
+
+    _file.reset(new QFile(sequenceFile(_directory, JournalPrefix, _sequence, JournalSuffix)));
+    if (!_file->open(QIODevice::ReadOnly)) {
+        _stopped = true; // no more journals
+        return false;
+    }
+
+    _stream.setDevice(_file.get());
+    _stream.setVersion(QDataStream::Qt_5_4);
+
+    quint32 magic, version, sequence, idCount;
+    _stream >> magic >> version >> sequence >> idCount;
+    if ((_stream.status() != QDataStream::Ok) || (magic != SnapshotJournalMagic) ||
+        (version != SnapshotJournalVersion) || (sequence != _sequence))
+    {
+        qWarning() << _file->fileName() << "is not a journal, or an unsupported version";
+        _stopped = true;
+        return false;
+    }
+
+    for (quint32 i = 0; i < idCount; ++i) {
+        qint32 id;
+        QByteArray path;
+        _stream >> id >> path;
+        if (_stream.status() != QDataStream::Ok) {
+            qWarning() << "truncated journal header:" << _file->fileName();
+            _stopped = true;
+            return false;
+        }
+
+        _ids.push_back(SnapshotJournal::IdPath{id, path});
+    }
+
+    return true;
+}
+
+bool SnapshotJournalReader::nextFrame(CanvasFrame& frame)
+{
+    if (_stopped || !_file || _stream.atEnd()) {
+        return false;
+    }
+
+    quint8 type;
+    QByteArray bytes;
+    _stream >> type >> bytes;
+    if (_stream.status() != QDataStream::Ok) {
+        // the last record was being written when we stopped: it, and any
+        // later journal, can't be trusted
+        _stopped = true;
+        return false;
+    }
+
+    if (type == JournalGap) {
+        _stopped = true;
+        return false;
+    }
+
+    if ((type != JournalFrame) || !decodeBinaryFrame(bytes, frame)) {
+        qWarning() << "corrupt journal record in" << _file->fileName();
+        _stopped = true;
+        return false;
+    }
+
+    return true;
+}
@@ -0,0 +1,221 @@
+//
+// Copyright (C) 2026 The fgqcanvas contributors
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as
+// published by the Free Software Foundation; either version 2 of the
+// License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+
+#ifndef SNAPSHOTJOURNAL_H
+#define SNAPSHOTJOURNAL_H
+
+#include <memory>
+#include <vector>
+
+#include <QByteArray>
+#include <QDataStream>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QMutex>
+#include <QString>
+#include <QUrl>
+#include <QWaitCondition>
+
+#include "canvasframe.h"
+#include "snapshotfile.h"
+
+class QThread;
+
+/**
+ * A journal keeps the last known state of one canvas on disk, continuously:
+ * a directory (see SnapshotJournal::canvasDirectory) of numbered checkpoints,
+ * each with the journal of the frames applied after it:
+ *
+ *   checkpoint-<sequence>.fgcanvassnapshot
+ *     a compressed snapshot of the canvas alone, see SnapshotCompressor
+ *
+ *   journal-<sequence>.fgqjournal
+ *     a QDataStream (Qt 5.4 format), a header and then records until the
+ *     end of the file:
+ *
+ *     header:
+ *       quint32     magic, SnapshotJournalMagic
+ *       quint32     version, currently 1
+ *       quint32     sequence, as in the file name
+ *       quint32     id count, then per id:
+ *         qint32      PropertyTreeMirror id live at the checkpoint
+ *         QByteArray  its path below the root, eg 'group[2]/path/coord[4]'
+ *
+ *     record:
+ *       quint8      type, a SnapshotJournalRecordType
+ *       QByteArray  an applied frame, see encodeBinaryFrame()
+ *
+ * The state is the latest complete checkpoint, with its journal and any
+ * later ones replayed in order: a journal is started before its checkpoint
+ * is complete, and older files are only deleted once it is.
+ */
+
+const quint32 SnapshotJournalMagic = 0x4647514a; // 'FGQJ'
+const quint32 SnapshotJournalVersion = 1;
+
+enum SnapshotJournalRecordType
+{
+    JournalFrame = 0,
+    JournalGap = 1 ///< frames were dropped: replaying must stop here
+};
+
+/**
+ * @brief Journals the frames applied to a canvas, with periodic
+ * checkpoints. Like SessionRecorder, journaling only queues the frame;
+ * encoding and writing happen on a background thread. If the writer falls
+ * too far behind, frames are dropped until the next checkpoint, which
+ * checkpointDue() then asks for at once.
+ */
+class SnapshotJournal
+{
+public:
+    struct Settings
+    {
+        QString directory; ///< for all canvases, see canvasDirectory()
+        qint64 checkpointIntervalMsec = 60 * 1000;
+        qint64 checkpointJournalBytes = 4 * 1024 * 1024; ///< checkpoint earlier beyond this
+    };
+
+    struct IdPath
+    {
+        int id;
+        QByteArray path; ///< below the root
+    };
+
+    using IdPaths = std::vector<IdPath>;
+
+    SnapshotJournal(const QUrl& url, const QByteArray& rootPath, const Settings& settings);
+
+    /// writes out everything queued, then stops the writer thread
+    ~SnapshotJournal();
+
+    /// the directory below settingsDirectory journaling the canvas
+    static QString canvasDirectory(const QString& settingsDirectory, const QUrl& url,
+                                   const QByteArray& rootPath);
+
+    QString directory() const
+    {
+        return _directory;
+    }
+
+    /**
+     * @brief start a new journal, from a snapshot holding the canvas alone.
+     * ids are the PropertyTreeMirror ids live now, which the frames
+     * appended from here on refer to.
+     */
+    void checkpoint(std::unique_ptr<SnapshotWriter> writer, IdPaths&& ids);
+
+    /// journal an applied frame; ignored before the first checkpoint
+    void append(const CanvasFrame& frame);
+
+    /**
+     * @brief whether to take a checkpoint: frames were journaled and the
+     * interval has passed, or the journal has grown large, or frames were
+     * dropped
+     */
+    bool checkpointDue() const;
+
+private:
+    class WriterThread;
+
+    enum class EntryType
+    {
+        Checkpoint,
+        Frame,
+        Gap
+    };
+
+    struct Entry
+    {
+        EntryType type;
+        quint32 sequence = 0;
+        std::unique_ptr<SnapshotWriter> writer;
+        IdPaths ids;
+        CanvasFrame frame;
+    };
+
+    bool enqueue(Entry&& e, qint64 size, bool always);
+    void writeLoop();
+    void write(Entry& e);
+    void writeCheckpoint(Entry& e);
+    void removeBefore(quint32 sequence);
+
+    const Settings _settings;
+    const QString _directory;
+
+    // only touched by the thread appending
+    quint32 _sequence = 0;
+    bool _started = false;
+    QElapsedTimer _sinceCheckpoint;
+    qint64 _journalBytes = 0;
+    bool _dropping = false;
+
+    QMutex _lock;
+    QWaitCondition _wake;
+    std::vector<Entry> _pending;
+    qint64 _pendingBytes = 0;
+    bool _stopping = false;
+
+    // only touched by the writer thread
+    std::unique_ptr<QFile> _journal;
+
+    std::unique_ptr<QThread> _thread;
+};
+
+/**
+ * @brief Reads back a canvas directory written by SnapshotJournal: the
+ * latest complete checkpoint, then the journals to replay over it, in order.
+ */
+class SnapshotJournalReader
+{
+public:
+    /// returns false if the directory holds no complete checkpoint
+    bool open(const QString& directory);
+
+    SnapshotFile::Ptr checkpoint() const
+    {
+        return _checkpoint;
+    }
+
+    /**
+     * @brief move to the next journal, starting with the checkpoint's own.
+     * Returns false once there are no more, or replaying reached a gap.
+     */
+    bool nextJournal();
+
+    /// the ids live at the start of the current journal
+    const SnapshotJournal::IdPaths& ids() const
+    {
+        return _ids;
+    }
+
+    /// returns false at the end of the current journal, if it is
+    /// truncated, or at a gap
+    bool nextFrame(CanvasFrame& frame);
+
+private:
+    QString _directory;
+    SnapshotFile::Ptr _checkpoint;
+    quint32 _sequence = 0;
+    bool _first = true;
+    bool _stopped = false;
+    std::unique_ptr<QFile> _file;
+    QDataStream _stream;
+    SnapshotJournal::IdPaths _ids;
+};
+
+#endif // SNAPSHOTJOURNAL_H
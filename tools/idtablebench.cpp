@@ -0,0 +1,105 @@
+//
+// Copyright (C) 2026 The fgqcanvas contributors
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as
+// published by the Free Software Foundation; either version 2 of the
+// License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+
+// Times mirror-id lookups, as done for every entry of a 'changed' section,
+// with the dense PropertyIdTable against the QHash<int, QPointer<LocalProp>>
+// it replaced. LocalProp is no longer a QObject, so the baseline now holds
+// raw pointers; the QPointer cost is no longer part of the comparison.
+
+#include <memory>
+#include <random>
+
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QDebug>
+#include <QElapsedTimer>
+#include <QHash>
+
+#include "localprop.h"
+#include "propertyidtable.h"
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    app.setApplicationName("fgqcanvas-idtable-bench");
+
+    QCommandLineParser parser;
+    parser.addHelpOption();
+    QCommandLineOption propsOption("props", "Number of live properties", "count", "50000");
+    QCommandLineOption lookupsOption("lookups", "Number of lookups to time", "count", "10000000");
+    parser.addOption(propsOption);
+    parser.addOption(lookupsOption);
+    parser.process(app);
+
+    const int propCount = qMax(1, parser.value(propsOption).toInt());
+    const int lookupCount = qMax(1, parser.value(lookupsOption).toInt());
+
+    // a canvas-like tree: groups of paths, each with a few leaves
+    std::unique_ptr<LocalProp> root(new LocalProp(nullptr, NameIndexTuple("")));
+    QHash<int, LocalProp*> dict;
+    PropertyIdTable table;
+
+    int nextId = 1;
+    for (int g = 0; nextId <= propCount; ++g) {
+        LocalProp* group = root->getOrCreateChildWithNameAndIndex(NameIndexTuple("group", g));
+        for (int p = 0; (p < 100) && (nextId <= propCount); ++p) {
+            LocalProp* path = group->getOrCreateChildWithNameAndIndex(NameIndexTuple("path", p));
+            for (int c = 0; (c < 10) && (nextId <= propCount); ++c) {
+                LocalProp* coord = path->getOrCreateChildWithNameAndIndex(NameIndexTuple("coord", c));
+                dict.insert(nextId, coord);
+                table.insert(nextId, coord);
+                ++nextId;
+            }
+        }
+    }
+
+    // changes arrive for scattered ids, so don't let either structure
+    // benefit from sequential access
+    std::vector<int> ids(lookupCount);
+    std::mt19937 rng(42);
+    std::uniform_int_distribution<int> dist(1, propCount);
+    for (int& id : ids) {
+        id = dist(rng);
+    }
+
+    QElapsedTimer timer;
+    quintptr check = 0;
+
+    timer.start();
+    for (int id : ids) {
+        if (dict.contains(id)) {
+            check += reinterpret_cast<quintptr>(dict.value(id));
+        }
+    }
+    const double hashNSec = timer.nsecsElapsed() / static_cast<double>(lookupCount);
+
+    timer.restart();
+    for (int id : ids) {
+        check -= reinterpret_cast<quintptr>(table.lookup(id));
+    }
+    const double tableNSec = timer.nsecsElapsed() / static_cast<double>(lookupCount);
+
+    qDebug().noquote() << QString("%1 live properties: QHash %2 nsec/lookup, "
+                                  "PropertyIdTable %3 nsec/lookup (%4x)")
+                          .arg(table.liveCount())
+                          .arg(hashNSec, 0, 'f', 2)
+                          .arg(tableNSec, 0, 'f', 2)
+                          .arg(hashNSec / tableNSec, 0, 'f', 1);
+
+    // both sums cancel out if the two structures agree
+    return (check == 0) ? 0 : 1;
+}
@@ -0,0 +1,152 @@
+//
+// Copyright (C) 2026 The fgqcanvas contributors
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as
+// published by the Free Software Foundation; either version 2 of the
+// License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+
+#include "mirrorserver.h"
+
+#include <QDebug>
+#include <QUrlQuery>
+#include <QtWebSockets/QWebSocket>
+#include <QtWebSockets/QWebSocketServer>
+
+#include "canvasframe.h"
+#include "canvasframecodec.h"
+
+static const QByteArray MirrorPathPrefix("/PropertyTreeMirror");
+
+MirrorServer::MirrorServer(QObject* pr) :
+    QObject(pr),
+    m_server(new QWebSocketServer("FGQCanvas mirror server", QWebSocketServer::NonSecureMode, this))
+{
+    connect(m_server, &QWebSocketServer::newConnection,
+            this, &MirrorServer::onNewConnection);
+}
+
+bool MirrorServer::listen(quint16 port)
+{
+    if (!m_server->listen(QHostAddress::Any, port)) {
+        qWarning() << "failed to listen on port" << port << m_server->errorString();
+        return false;
+    }
+
+    return true;
+}
+
+void MirrorServer::broadcast(const CanvasFrame& frame)
+{
+    QByteArray text, binary;
+    for (const Client& c : m_clients) {
+        if (c.binary) {
+            if (binary.isEmpty())
+                binary = encodeBinaryFrame(frame);
+            c.socket->sendBinaryMessage(binary);
+            m_binaryBytesSent += binary.size();
+        } else {
+            if (text.isEmpty())
+                text = encodeJsonFrame(frame);
+            c.socket->sendTextMessage(QString::fromUtf8(text));
+            m_textBytesSent += text.size();
+        }
+    }
+}
+
+void MirrorServer::send(QWebSocket* client, const CanvasFrame& frame)
+{
+    if (isBinaryClient(client)) {
+        const QByteArray bytes = encodeBinaryFrame(frame);
+        client->sendBinaryMessage(bytes);
+        m_binaryBytesSent += bytes.size();
+    } else {
+        const QByteArray bytes = encodeJsonFrame(frame);
+        client->sendTextMessage(QString::fromUtf8(bytes));
+        m_textBytesSent += bytes.size();
+    }
+}
+
+void MirrorServer::sendEncoded(QWebSocket* client, const QByteArray& bytes, bool binary)
+{
+    if (isBinaryClient(client) != binary) {
+        CanvasFrame frame;
+        const bool ok = binary ? decodeBinaryFrame(bytes, frame) : decodeJsonFrame(bytes, frame);
+        if (!ok) {
+            qWarning() << "can't transcode malformed frame";
+            return;
+        }
+
+        send(client, frame);
+        return;
+    }
+
+    if (binary) {
+        client->sendBinaryMessage(bytes);
+        m_binaryBytesSent += bytes.size();
+    } else {
+        client->sendTextMessage(QString::fromUtf8(bytes));
+        m_textBytesSent += bytes.size();
+    }
+}
+
+void MirrorServer::onNewConnection()
+{
+    while (m_server->hasPendingConnections()) {
+        QWebSocket* socket = m_server->nextPendingConnection();
+        const QUrl url = socket->requestUrl();
+        const QByteArray path = url.path().toUtf8();
+        if (!path.startsWith(MirrorPathPrefix)) {
+            qWarning() << "rejecting connection to" << url;
+            socket->close(QWebSocketProtocol::CloseCodeBadOperation);
+            socket->deleteLater();
+            continue;
+        }
+
+        Client c;
+        c.socket = socket;
+        c.rootPath = path.mid(MirrorPathPrefix.size());
+        c.binary = (QUrlQuery(url).queryItemValue("encoding") == QStringLiteral("binary"));
+        m_clients.append(c);
+
+        connect(socket, &QWebSocket::disconnected,
+                this, &MirrorServer::onClientDisconnected);
+
+        qDebug() << "client connected for" << c.rootPath << (c.binary ? "(binary)" : "(JSON)");
+        emit clientConnected(socket, c.rootPath);
+    }
+}
+
+void MirrorServer::onClientDisconnected()
+{
+    QWebSocket* socket = qobject_cast<QWebSocket*>(sender());
+    auto it = std::find_if(m_clients.begin(), m_clients.end(), [socket](const Client& c)
+    {
+        return c.socket == socket;
+    });
+
+    if (it != m_clients.end()) {
+        m_clients.erase(it);
+    }
+
+    socket->deleteLater();
+}
+
+bool MirrorServer::isBinaryClient(QWebSocket* socket) const
+{
+    for (const Client& c : m_clients) {
+        if (c.socket == socket)
+            return c.binary;
+    }
+
+    return false;
+}
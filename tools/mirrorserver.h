@@ -0,0 +1,87 @@
+//
+// Copyright (C) 2026 The fgqcanvas contributors
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as
+// published by the Free Software Foundation; either version 2 of the
+// License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+
+#ifndef MIRRORSERVER_H
+#define MIRRORSERVER_H
+
+#include <QObject>
+#include <QList>
+#include <QByteArray>
+
+class QWebSocket;
+class QWebSocketServer;
+struct CanvasFrame;
+
+/**
+ * @brief Minimal stand-in for the FlightGear PropertyTreeMirror websocket
+ * service. Clients connect to ws://host:port/PropertyTreeMirror/<root-path>,
+ * optionally with 'encoding=binary' in the query, and are sent frames in
+ * the encoding they asked for.
+ */
+class MirrorServer : public QObject
+{
+    Q_OBJECT
+public:
+    explicit MirrorServer(QObject* pr = nullptr);
+
+    bool listen(quint16 port);
+
+    /// encode the frame once per wire format in use, and send to all clients
+    void broadcast(const CanvasFrame& frame);
+
+    void send(QWebSocket* client, const CanvasFrame& frame);
+
+    /**
+     * @brief send an already encoded frame, eg from a recording. It is
+     * transcoded if the client asked for the other encoding.
+     */
+    void sendEncoded(QWebSocket* client, const QByteArray& bytes, bool binary);
+
+    int clientCount() const
+    {
+        return m_clients.size();
+    }
+
+    qint64 bytesSent(bool binary) const
+    {
+        return binary ? m_binaryBytesSent : m_textBytesSent;
+    }
+
+signals:
+    void clientConnected(QWebSocket* client, QByteArray rootPath);
+
+private slots:
+    void onNewConnection();
+    void onClientDisconnected();
+
+private:
+    struct Client
+    {
+        QWebSocket* socket;
+        QByteArray rootPath;
+        bool binary;
+    };
+
+    bool isBinaryClient(QWebSocket* socket) const;
+
+    QWebSocketServer* m_server;
+    QList<Client> m_clients;
+    qint64 m_textBytesSent = 0;
+    qint64 m_binaryBytesSent = 0;
+};
+
+#endif // MIRRORSERVER_H
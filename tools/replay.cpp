@@ -0,0 +1,249 @@
+//
+// Copyright (C) 2026 The fgqcanvas contributors
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as
+// published by the Free Software Foundation; either version 2 of the
+// License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+
+// Serves session recordings (made with 'fgqcanvas --record', see
+// sessionrecorder.h) as a PropertyTreeMirror server, so an unmodified
+// FGQCanvas can connect and the whole ingest / polish / render pipeline
+// can be profiled without FlightGear. Every client is sent the complete
+// recording from the start, at the recorded pace, N times faster, or as
+// fast as the socket accepts it.
+
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QDebug>
+#include <QElapsedTimer>
+#include <QPointer>
+#include <QTimer>
+#include <QtWebSockets/QWebSocket>
+
+#include "sessionrecorder.h"
+#include "mirrorserver.h"
+
+// as-fast-as-possible playback still returns to the event loop after this
+// many frames, or while this much is waiting to be written, so the socket
+// can drain and other clients get a turn
+static const int MaxBurstFrames = 64;
+static const qint64 MaxSocketBacklog = 4 * 1024 * 1024;
+
+class ReplaySession
+{
+public:
+    /// speed is a multiple of the recorded pace, or 0 for as fast as possible
+    ReplaySession(MirrorServer* server, QWebSocket* client, QByteArray rootPath,
+                  const QStringList& files, double speed) :
+        _server(server),
+        _client(client),
+        _rootPath(rootPath),
+        _files(files),
+        _speed(speed)
+    {
+        _timer.setSingleShot(true);
+        _timer.setTimerType(Qt::PreciseTimer);
+        QObject::connect(&_timer, &QTimer::timeout, [this]() { pump(); });
+    }
+
+    void start(std::function<void()> onFinished)
+    {
+        _onFinished = onFinished;
+        _hasRecord = readNext();
+        _firstUsec = _record.usec;
+        _clock.start();
+        pump();
+    }
+
+    bool isFinished() const
+    {
+        return _finished;
+    }
+
+private:
+    void pump()
+    {
+        if (!_client) {
+            finish("client disconnected");
+            return;
+        }
+
+        const qint64 nowUsec = _clock.nsecsElapsed() / 1000;
+        int burst = 0;
+        while (_hasRecord) {
+            if (_speed > 0.0) {
+                const qint64 dueUsec = static_cast<qint64>((_record.usec - _firstUsec) / _speed);
+                if (dueUsec > nowUsec) {
+                    _timer.start(static_cast<int>((dueUsec - nowUsec) / 1000));
+                    return;
+                }
+            } else if ((burst >= MaxBurstFrames) || (_client->bytesToWrite() > MaxSocketBacklog)) {
+                _timer.start(0);
+                return;
+            }
+
+            if (_record.type == RecordGap) {
+                qWarning() << "the recording dropped frames at" << (_record.usec - _firstUsec) / 1000
+                           << "msec: clients may see unknown ids from here";
+                ++_gaps;
+            } else {
+                _server->sendEncoded(_client, _record.bytes, _record.type == RecordBinaryFrame);
+                _bytes += _record.bytes.size();
+                ++_frames;
+                ++burst;
+            }
+            _hasRecord = readNext();
+        }
+
+        finish("done");
+    }
+
+    bool readNext()
+    {
+        for (;;) {
+            if (_reader && _reader->next(_record)) {
+                return true;
+            }
+
+            if (_nextFile >= _files.size()) {
+                return false;
+            }
+
+            _reader.reset(new SessionReader);
+            if (!_reader->open(_files.at(_nextFile++))) {
+                _reader.reset();
+                continue;
+            }
+
+            if (_reader->rootPath() != _rootPath) {
+                qWarning() << "client asked for" << _rootPath << "but the recording is of"
+                           << _reader->rootPath() << "- replaying anyway";
+            }
+        }
+    }
+
+    void finish(const char* reason)
+    {
+        if (_finished) {
+            return;
+        }
+
+        _finished = true;
+        const double secs = _clock.nsecsElapsed() / 1e9;
+        qDebug().noquote() << QString("replay %1: %2 frames, %3 bytes in %4 sec (%5 frames/sec), %6 gaps")
+                              .arg(reason).arg(_frames).arg(_bytes)
+                              .arg(secs, 0, 'f', 3).arg(_frames / qMax(secs, 1e-6), 0, 'f', 1)
+                              .arg(_gaps);
+        if (_onFinished) {
+            _onFinished();
+        }
+    }
+
+    MirrorServer* _server;
+    QPointer<QWebSocket> _client;
+    const QByteArray _rootPath;
+    const QStringList _files;
+    const double _speed;
+
+    std::unique_ptr<SessionReader> _reader;
+    int _nextFile = 0;
+    SessionReader::Record _record;
+    bool _hasRecord = false;
+    qint64 _firstUsec = 0;
+
+    QTimer _timer;
+    QElapsedTimer _clock;
+    qint64 _frames = 0;
+    qint64 _bytes = 0;
+    qint64 _gaps = 0;
+    bool _finished = false;
+    std::function<void()> _onFinished;
+};
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    app.setApplicationName("fgqcanvas-replay");
+
+    QCommandLineParser parser;
+    parser.addHelpOption();
+    parser.addPositionalArgument("segments", "Recording segment files, in order", "<file>...");
+    QCommandLineOption portOption("port", "Port to listen on", "port", "8080");
+    QCommandLineOption speedOption("speed", "Playback speed: a multiple of the recorded pace, or 'max'",
+                                   "speed", "1");
+    QCommandLineOption exitOption("exit-when-done", "Quit once every client has been sent the recording");
+    parser.addOption(portOption);
+    parser.addOption(speedOption);
+    parser.addOption(exitOption);
+    parser.process(app);
+
+    const QStringList files = parser.positionalArguments();
+    if (files.isEmpty()) {
+        parser.showHelp(1);
+    }
+
+    for (const QString& f : files) {
+        SessionReader reader;
+        if (!reader.open(f)) {
+            return 1;
+        }
+
+        qDebug() << f << ": segment" << reader.segmentNumber() << "of" << reader.url()
+                 << "root" << reader.rootPath();
+        if ((f == files.front()) && (reader.segmentNumber() != 0)) {
+            qWarning() << "the first file isn't the first segment of its session, so the"
+                       << "initial sync is missing and clients will see unknown ids";
+        }
+    }
+
+    double speed = 0.0;
+    if (parser.value(speedOption) != QStringLiteral("max")) {
+        speed = parser.value(speedOption).toDouble();
+        if (speed <= 0.0) {
+            qWarning() << "invalid speed" << parser.value(speedOption);
+            return 1;
+        }
+    }
+
+    MirrorServer server;
+    if (!server.listen(static_cast<quint16>(parser.value(portOption).toUInt()))) {
+        return 1;
+    }
+
+    const bool exitWhenDone = parser.isSet(exitOption);
+    std::vector<std::unique_ptr<ReplaySession>> sessions;
+    QObject::connect(&server, &MirrorServer::clientConnected,
+                     [&](QWebSocket* client, QByteArray rootPath)
+    {
+        sessions.emplace_back(new ReplaySession(&server, client, rootPath, files, speed));
+        sessions.back()->start([&sessions, exitWhenDone]()
+        {
+            if (!exitWhenDone) {
+                return;
+            }
+
+            for (const auto& s : sessions) {
+                if (!s->isFinished())
+                    return;
+            }
+
+            QTimer::singleShot(0, qApp, &QCoreApplication::quit);
+        });
+    });
+
+    return app.exec();
+}
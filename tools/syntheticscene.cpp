@@ -0,0 +1,214 @@
+//
+// Copyright (C) 2026 The fgqcanvas contributors
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as
+// published by the Free Software Foundation; either version 2 of the
+// License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+
+#include "syntheticscene.h"
+
+#include <cmath>
+
+#include <QString>
+
+static const double CanvasSize = 1024.0;
+
+static QByteArray indexed(const QByteArray& path, const char* name, int index)
+{
+    return path + '/' + name + '[' + QByteArray::number(index) + ']';
+}
+
+/// allocates ids sequentially from one
+class SyntheticScene::Builder
+{
+public:
+    Builder(CanvasFrame& frame) :
+        _frame(frame)
+    {}
+
+    int add(const QByteArray& path, PropValue value, unsigned int position = 0)
+    {
+        CanvasFrame::Created c;
+        c.id = static_cast<int>(_frame.created.size()) + 1;
+        c.path = path;
+        c.position = position;
+        c.value = value;
+        _frame.created.push_back(c);
+        return c.id;
+    }
+
+    /// an identity tf, plus a translation; returns the id of m[0]
+    int addTf(const QByteArray& nodePath, QPointF translation = QPointF())
+    {
+        add(nodePath + "/tf", PropValue());
+        const double m[6] = {1.0, 0.0, 0.0, 1.0, translation.x(), translation.y()};
+        int firstM = 0;
+        for (int i = 0; i < 6; ++i) {
+            const int id = add(indexed(nodePath + "/tf", "m", i), m[i]);
+            if (i == 0) {
+                firstM = id;
+            }
+        }
+        return firstM;
+    }
+
+private:
+    CanvasFrame& _frame;
+};
+
+SyntheticScene::SyntheticScene(const Settings& settings) :
+    _settings(settings),
+    _coordsPerPath(qMax(4, settings.coordsPerPath + (settings.coordsPerPath % 2)))
+{
+    CanvasFrame frame;
+    build(QByteArray(), frame, _animation);
+    _propertyCount = static_cast<int>(frame.created.size());
+}
+
+CanvasFrame SyntheticScene::initialFrame(const QByteArray& rootPath) const
+{
+    CanvasFrame frame;
+    Animation unused;
+    build(rootPath, frame, unused);
+    return frame;
+}
+
+void SyntheticScene::build(const QByteArray& rootPath, CanvasFrame& frame, Animation& animation) const
+{
+    Builder b(frame);
+    b.add(rootPath + "/size", CanvasSize);
+    b.add(rootPath + "/size[1]", CanvasSize);
+
+    // paths are laid out on a grid covering the canvas, across all groups
+    const int totalPaths = qMax(1, _settings.groups * _settings.pathsPerGroup);
+    const int columns = qMax(1, static_cast<int>(std::ceil(std::sqrt(static_cast<double>(totalPaths)))));
+    const double cell = CanvasSize / columns;
+
+    int pathIndex = 0;
+    for (int g = 0; g < _settings.groups; ++g) {
+        const QByteArray group = indexed(rootPath, "group", g);
+        b.add(group, PropValue(), g);
+
+        // the whole group sways slowly
+        AnimatedTf groupTf;
+        groupTf.firstM = b.addTf(group);
+        groupTf.centre = QPointF(CanvasSize / 2, CanvasSize / 2);
+        groupTf.phase = g * 0.7;
+        groupTf.rate = 0.05;
+        animation.tfs.push_back(groupTf);
+
+        for (int p = 0; p < _settings.pathsPerGroup; ++p, ++pathIndex) {
+            const QByteArray path = indexed(group, "path", p);
+            const QPointF centre((pathIndex % columns + 0.5) * cell, (pathIndex / columns + 0.5) * cell);
+            b.add(path, PropValue(), p);
+            b.add(path + "/stroke", "#00ff00");
+            b.add(path + "/stroke-width", 2);
+
+            // a closed polygon through coordsPerPath / 2 points
+            const int points = _coordsPerPath / 2;
+            for (int c = 0; c < points; ++c) {
+                b.add(indexed(path, "cmd", c), (c == 0) ? 2 : 4); // move, then lines
+            }
+            b.add(indexed(path, "cmd", points), 0); // close
+
+            AnimatedPath ap;
+            ap.centre = centre;
+            ap.phase = pathIndex * 0.1;
+            const double radius = cell * 0.35;
+            for (int c = 0; c < points; ++c) {
+                const double a = (2.0 * M_PI * c) / points;
+                const int id = b.add(indexed(path, "coord", c * 2), centre.x() + radius * std::cos(a));
+                b.add(indexed(path, "coord", c * 2 + 1), centre.y() + radius * std::sin(a));
+                if (c == 0) {
+                    ap.firstCoord = id;
+                }
+            }
+
+            AnimatedTf tf;
+            tf.firstM = b.addTf(path);
+            tf.centre = centre;
+            tf.phase = pathIndex * 0.1;
+            tf.rate = 1.0;
+
+            // spread the churn evenly, rather than animating the first N paths
+            const double slot = (pathIndex + 0.5) / totalPaths;
+            if (slot < _settings.tfChurn) {
+                animation.tfs.push_back(tf);
+            }
+
+            if (slot < _settings.coordChurn) {
+                animation.paths.push_back(ap);
+            }
+        }
+
+        for (int t = 0; t < _settings.textsPerGroup; ++t) {
+            const QByteArray text = indexed(group, "text", t);
+            b.add(text, PropValue(), _settings.pathsPerGroup + t);
+            b.add(text + "/font", "LiberationFonts/LiberationMono-Regular.ttf");
+            b.add(text + "/character-size", 24);
+            b.add(text + "/fill", "#ffffff");
+            b.add(text + "/alignment", "left-baseline");
+            animation.textIds.push_back(b.add(text + "/text", "0000.0"));
+            b.addTf(text, QPointF(20.0 + 140.0 * (t % 7), 40.0 + 32.0 * (t / 7)));
+        }
+
+        for (int i = 0; i < _settings.imagesPerGroup; ++i) {
+            const QByteArray image = indexed(group, "image", i);
+            b.add(image, PropValue(), _settings.pathsPerGroup + _settings.textsPerGroup + i);
+            b.add(image + "/file", "Aircraft/Instruments/Textures/synthetic.png");
+            b.add(image + "/size", 64);
+            b.add(image + "/size[1]", 64);
+            b.addTf(image, QPointF(64.0 * (i % 16), CanvasSize - 64.0 * (1 + i / 16)));
+        }
+    }
+}
+
+CanvasFrame SyntheticScene::tick(double t) const
+{
+    CanvasFrame frame;
+    frame.changed.reserve(_animation.tfs.size() * 6 + _animation.paths.size() * 2 + _animation.textIds.size());
+
+    auto change = [&frame](int id, PropValue value)
+    {
+        CanvasFrame::Changed c;
+        c.id = id;
+        c.value = value;
+        frame.changed.push_back(c);
+    };
+
+    // rotate about the centre
+    for (const AnimatedTf& tf : _animation.tfs) {
+        const double a = tf.phase + t * tf.rate;
+        const double x = tf.centre.x(), y = tf.centre.y();
+        const double m[6] = { std::cos(a), std::sin(a), -std::sin(a), std::cos(a),
+                              x - x * std::cos(a) + y * std::sin(a),
+                              y - x * std::sin(a) - y * std::cos(a) };
+        for (int i = 0; i < 6; ++i) {
+            change(tf.firstM + i, m[i]);
+        }
+    }
+
+    // wobble the first point of the polygon
+    for (const AnimatedPath& p : _animation.paths) {
+        const double a = p.phase + t * 3.0;
+        change(p.firstCoord, p.centre.x() + 10.0 * std::cos(a));
+        change(p.firstCoord + 1, p.centre.y() + 10.0 * std::sin(a));
+    }
+
+    for (size_t i = 0; i < _animation.textIds.size(); ++i) {
+        const double v = std::fmod(t * 37.0 + i * 11.0, 10000.0);
+        change(_animation.textIds[i], QString::number(v, 'f', 1).rightJustified(6, '0'));
+    }
+
+    return frame;
+}
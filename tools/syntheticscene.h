@@ -0,0 +1,95 @@
+//
+// Copyright (C) 2026 The fgqcanvas contributors
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as
+// published by the Free Software Foundation; either version 2 of the
+// License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+
+#ifndef SYNTHETICSCENE_H
+#define SYNTHETICSCENE_H
+
+#include <vector>
+
+#include <QByteArray>
+#include <QPointF>
+
+#include "canvasframe.h"
+
+/**
+ * @brief Fakes a FlightGear canvas of configurable size: groups of paths,
+ * text readouts and images, animated by rewriting tf matrices, coordinates
+ * and text values, as PropertyTreeMirror frames.
+ */
+class SyntheticScene
+{
+public:
+    struct Settings
+    {
+        int groups = 1;
+        int pathsPerGroup = 20;
+        int coordsPerPath = 8;   ///< rounded up to an even number, at least 4
+        int textsPerGroup = 0;
+        int imagesPerGroup = 0;
+        double tfChurn = 1.0;    ///< fraction of paths whose tf changes every tick
+        double coordChurn = 0.0; ///< fraction of paths whose coords change every tick
+    };
+
+    SyntheticScene(const Settings& settings);
+
+    /// the complete created section for a client mirroring rootPath. Ids
+    /// are allocated sequentially from one, the same for every root path.
+    CanvasFrame initialFrame(const QByteArray& rootPath) const;
+
+    /// the changes for time t, in seconds
+    CanvasFrame tick(double t) const;
+
+    /// number of properties in the initial frame
+    int propertyCount() const
+    {
+        return _propertyCount;
+    }
+
+private:
+    struct AnimatedTf
+    {
+        int firstM; ///< id of m[0], m[1..5] follow
+        QPointF centre;
+        double phase;
+        double rate; ///< radians per second
+    };
+
+    struct AnimatedPath
+    {
+        int firstCoord = 0;
+        QPointF centre;
+        double phase;
+    };
+
+    class Builder;
+
+    struct Animation
+    {
+        std::vector<AnimatedTf> tfs;
+        std::vector<AnimatedPath> paths;
+        std::vector<int> textIds;
+    };
+
+    void build(const QByteArray& rootPath, CanvasFrame& frame, Animation& animation) const;
+
+    const Settings _settings;
+    const int _coordsPerPath;
+    int _propertyCount = 0;
+    Animation _animation; ///< ids don't depend on the root path, so computed once
+};
+
+#endif // SYNTHETICSCENE_H
@@ -0,0 +1,194 @@
+//
+// Copyright (C) 2026 The fgqcanvas contributors
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as
+// published by the Free Software Foundation; either version 2 of the
+// License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+
+// Local PropertyTreeMirror server which animates a synthetic canvas of
+// configurable size, so FGQCanvas can be run and stress-tested without
+// FlightGear, and so the JSON and binary frame encodings can be compared.
+// Run with --bench to time the codecs offline instead of serving.
+
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QDebug>
+#include <QElapsedTimer>
+#include <QJsonDocument>
+#include <QJsonArray>
+#include <QJsonObject>
+#include <QTimer>
+#include <QtWebSockets/QWebSocket>
+
+#include "canvasframe.h"
+#include "canvasframecodec.h"
+#include "mirrorserver.h"
+#include "syntheticscene.h"
+
+// the previous, document based JSON decoding, as a baseline for the benchmark
+static void decodeJsonWithDocument(const QByteArray& utf8, CanvasFrame& frame)
+{
+    frame.clear();
+    const QJsonObject obj = QJsonDocument::fromJson(utf8).object();
+    for (const QJsonValue& v : obj.value("created").toArray()) {
+        QJsonObject newProp = v.toObject();
+        CanvasFrame::Created c;
+        c.id = newProp.value("id").toInt();
+        c.position = static_cast<unsigned int>(newProp.value("position").toInt());
+        c.path = newProp.value("path").toString().toUtf8();
+        c.value = PropValue::fromVariant(newProp.value("value").toVariant());
+        frame.created.push_back(c);
+    }
+
+    for (const QJsonValue& v : obj.value("removed").toArray()) {
+        frame.removed.push_back(v.toInt());
+    }
+
+    for (const QJsonValue& v : obj.value("changed").toArray()) {
+        QJsonArray change = v.toArray();
+        CanvasFrame::Changed c;
+        c.id = change.at(0).toInt();
+        c.value = PropValue::fromVariant(change.at(1).toVariant());
+        frame.changed.push_back(c);
+    }
+}
+
+static void runBenchmark(const SyntheticScene& scene, int iterations)
+{
+    const CanvasFrame created = scene.initialFrame("/canvas/by-index/texture[0]");
+    const CanvasFrame changed = scene.tick(1.0);
+
+    for (const CanvasFrame* f : {&created, &changed}) {
+        const char* label = (f == &created) ? "created" : "changed";
+        const QByteArray json = encodeJsonFrame(*f);
+        const QByteArray binary = encodeBinaryFrame(*f);
+
+        const QString jsonText = QString::fromUtf8(json);
+
+        CanvasFrame decoded;
+        QElapsedTimer timer;
+        timer.start();
+        for (int i = 0; i < iterations; ++i) {
+            decodeJsonWithDocument(jsonText.toUtf8(), decoded);
+        }
+        const double documentUSec = timer.nsecsElapsed() / (1000.0 * iterations);
+
+        timer.restart();
+        for (int i = 0; i < iterations; ++i) {
+            decodeJsonFrame(jsonText, decoded);
+        }
+        const double jsonUSec = timer.nsecsElapsed() / (1000.0 * iterations);
+
+        timer.restart();
+        for (int i = 0; i < iterations; ++i) {
+            decodeBinaryFrame(binary, decoded);
+        }
+        const double binaryUSec = timer.nsecsElapsed() / (1000.0 * iterations);
+
+        qDebug().noquote() << QString("%1 frame: JSON %2 bytes, %3 usec/decode (%4 with QJsonDocument); "
+                                      "binary %5 bytes, %6 usec/decode")
+                             .arg(label).arg(json.size()).arg(jsonUSec, 0, 'f', 2)
+                             .arg(documentUSec, 0, 'f', 2)
+                             .arg(binary.size()).arg(binaryUSec, 0, 'f', 2);
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    app.setApplicationName("fgqcanvas-testserver");
+
+    QCommandLineParser parser;
+    parser.addHelpOption();
+    QCommandLineOption portOption("port", "Port to listen on", "port", "8080");
+    QCommandLineOption groupsOption("groups", "Number of groups", "count", "1");
+    QCommandLineOption pathsOption("paths", "Number of paths per group", "count", "20");
+    QCommandLineOption coordsOption("coords", "Number of coordinates per path", "count", "8");
+    QCommandLineOption textsOption("texts", "Number of animated text readouts per group", "count", "0");
+    QCommandLineOption imagesOption("images", "Number of images per group", "count", "0");
+    QCommandLineOption tfChurnOption("tf-churn", "Fraction of paths whose transform changes every update",
+                                     "fraction", "1");
+    QCommandLineOption coordChurnOption("coord-churn", "Fraction of paths whose coordinates change every update",
+                                        "fraction", "0");
+    QCommandLineOption rateOption("rate", "Updates per second", "hz", "30");
+    QCommandLineOption benchOption("bench", "Time the frame codecs and exit", "iterations");
+    parser.addOption(portOption);
+    parser.addOption(groupsOption);
+    parser.addOption(pathsOption);
+    parser.addOption(coordsOption);
+    parser.addOption(textsOption);
+    parser.addOption(imagesOption);
+    parser.addOption(tfChurnOption);
+    parser.addOption(coordChurnOption);
+    parser.addOption(rateOption);
+    parser.addOption(benchOption);
+    parser.process(app);
+
+    SyntheticScene::Settings settings;
+    settings.groups = qMax(0, parser.value(groupsOption).toInt());
+    settings.pathsPerGroup = qMax(0, parser.value(pathsOption).toInt());
+    settings.coordsPerPath = parser.value(coordsOption).toInt();
+    settings.textsPerGroup = qMax(0, parser.value(textsOption).toInt());
+    settings.imagesPerGroup = qMax(0, parser.value(imagesOption).toInt());
+    settings.tfChurn = qBound(0.0, parser.value(tfChurnOption).toDouble(), 1.0);
+    settings.coordChurn = qBound(0.0, parser.value(coordChurnOption).toDouble(), 1.0);
+    SyntheticScene scene(settings);
+
+    const CanvasFrame sample = scene.tick(0.0);
+    qDebug() << "scene has" << scene.propertyCount() << "properties," << sample.changed.size()
+             << "changes per update";
+
+    if (parser.isSet(benchOption)) {
+        runBenchmark(scene, qMax(1, parser.value(benchOption).toInt()));
+        return 0;
+    }
+
+    MirrorServer server;
+    if (!server.listen(static_cast<quint16>(parser.value(portOption).toUInt()))) {
+        return 1;
+    }
+
+    QObject::connect(&server, &MirrorServer::clientConnected,
+                     [&server, &scene](QWebSocket* client, QByteArray rootPath)
+    {
+        server.send(client, scene.initialFrame(rootPath));
+    });
+
+    QElapsedTimer clock;
+    clock.start();
+
+    QTimer tickTimer;
+    tickTimer.setTimerType(Qt::PreciseTimer);
+    tickTimer.setInterval(1000 / qMax(1, parser.value(rateOption).toInt()));
+    QObject::connect(&tickTimer, &QTimer::timeout, [&server, &scene, &clock]()
+    {
+        if (server.clientCount() > 0) {
+            server.broadcast(scene.tick(clock.elapsed() / 1000.0));
+        }
+    });
+    tickTimer.start();
+
+    QTimer statsTimer;
+    statsTimer.setInterval(10 * 1000);
+    QObject::connect(&statsTimer, &QTimer::timeout, [&server]()
+    {
+        static qint64 lastTotal = 0;
+        const qint64 total = server.bytesSent(false) + server.bytesSent(true);
+        qDebug() << "sent" << server.bytesSent(false) << "JSON bytes," << server.bytesSent(true) << "binary bytes,"
+                 << (total - lastTotal) / 10240 << "KB/sec to" << server.clientCount() << "clients";
+        lastTotal = total;
+    });
+    statsTimer.start();
+
+    return app.exec();
+}